@@ -0,0 +1,40 @@
+#include "main.h"
+
+#define SCANS 64 // Scans per half buffer
+
+uint16_t block[2 * SCANS * 3] = {0};
+uint32_t average[3] = {0};
+__IO uint8_t ready = 0;
+
+AnalogIn ain1(PA_0); // Channel 0
+AnalogIn ain2(PA_1); // Channel 1
+AnalogIn ain3(PA_2); // Channel 2
+
+void Block(uint16_t* data, uint16_t scans)
+{
+	uint16_t i = 0;
+	uint8_t j = 0;
+
+	// Coherent frames: data[scan * ranks + rank]
+	for(j = 0; j < 3; j++) average[j] = 0;
+
+	for(i = 0; i < scans; i++) {
+		for(j = 0; j < 3; j++) average[j] += data[(i * 3) + j];
+	}
+
+	for(j = 0; j < 3; j++) average[j] /= scans;
+
+	ready = 1;
+}
+
+int main(void)
+{
+	AnalogIn::block(block, SCANS, &Block);
+
+	while(1)
+	{
+		if(ready) {
+			ready = 0;
+		}
+	}
+}
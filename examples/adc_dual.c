@@ -0,0 +1,21 @@
+#include "main.h"
+
+uint16_t current = 0;
+uint16_t voltage = 0;
+
+AnalogIn ain1(PA_0); // Channel 0 (ADC1)
+
+int main(void)
+{
+	// Low impedance source (shunt amplifier)
+	ain1.impedance(1000);
+
+	// Voltage divider on ADC2, sampled at the same instant
+	ain1.pair(PA_1); // Channel 1 (ADC2)
+
+	while(1)
+	{
+		current = ain1.read();
+		voltage = ain1.read_pair();
+	}
+}
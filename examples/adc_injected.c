@@ -0,0 +1,29 @@
+#include "main.h"
+
+#define FREQUENCY 20000 // 20kHz
+
+PinName pins[2] = {PA_1, PA_2};
+uint16_t current[2] = {0};
+
+PwmOut pwm1(PA_8, FREQUENCY, TIM1, Channel_1);
+
+AnalogIn ain1(PB_0); // Channel 8 (housekeeping, regular scan)
+
+void Injected(uint16_t* values, uint8_t count)
+{
+	// Sampled on each PWM period
+	current[0] = values[0];
+	current[1] = values[1];
+}
+
+int main(void)
+{
+	pwm1.write(50);
+
+	// Phase currents converted on TIM1 update
+	AnalogIn::injected(pins, 2, Sample_7_5, &pwm1, &Injected);
+
+	while(1)
+	{
+	}
+}
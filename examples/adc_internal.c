@@ -0,0 +1,21 @@
+#include "main.h"
+
+uint16_t vdda = 0;
+uint16_t voltage = 0;
+int16_t temperature = 0;
+
+AnalogIn ain1(PA_0);               // Channel 0
+AnalogIn vref(Adc_Vrefint);        // Channel 17
+AnalogIn sensor(Adc_Temperature);  // Channel 16
+
+int main(void)
+{
+	while(1)
+	{
+		vdda = AnalogIn::vdda();                 // mV
+		voltage = ain1.read_mv();                // mV, supply drift compensated
+		temperature = sensor.read_temperature(); // 0.1 degC
+
+		Delay(1000);
+	}
+}
@@ -0,0 +1,42 @@
+#include "main.h"
+
+#define SCANS 64 // Scans per half buffer (4 outputs at 2^4)
+
+uint16_t block[2 * SCANS * 2] = {0};
+uint16_t value[2] = {0};
+__IO uint8_t alarm = 0;
+
+Timer timer(TIM3);
+
+AnalogIn ain1(PA_0); // Channel 0
+AnalogIn ain2(PA_1); // Channel 1
+
+void Block(uint16_t* data, uint16_t scans)
+{
+	// 14 bits results, last output scan
+	value[0] = data[((scans - 1) * 2) + 0];
+	value[1] = data[((scans - 1) * 2) + 1];
+}
+
+void Alarm(void)
+{
+	alarm = 1;
+}
+
+int main(void)
+{
+	AnalogIn::block(block, SCANS, &Block);
+	AnalogIn::oversample(4, Filter_Cic, 14);
+	AnalogIn::trigger(&timer, 16000);
+
+	// Over-voltage on channel 1
+	ain2.watchdog(0, 3500, &Alarm);
+
+	while(1)
+	{
+		if(alarm) {
+			alarm = 0;
+			AnalogIn::watchdog_arm();
+		}
+	}
+}
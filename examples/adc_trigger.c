@@ -0,0 +1,31 @@
+#include "main.h"
+
+#define SCANS 100 // Scans per half buffer
+#define RATE  10000 // 10kHz
+
+uint16_t block[2 * SCANS * 2] = {0};
+uint32_t rate = 0;
+uint16_t* __IO current = 0;
+
+Timer timer(TIM3);
+
+AnalogIn ain1(PA_0); // Channel 0
+AnalogIn ain2(PA_1); // Channel 1
+
+void Block(uint16_t* data, uint16_t scans)
+{
+	// One half ready (10ms at 10kHz)
+	current = data;
+}
+
+int main(void)
+{
+	AnalogIn::block(block, SCANS, &Block);
+
+	// Sampling on TIM3 update (TRGO)
+	rate = AnalogIn::trigger(&timer, RATE);
+
+	while(1)
+	{
+	}
+}
@@ -0,0 +1,23 @@
+#include "main.h"
+
+#define SAMPLES 64
+
+// Sine table, 12 bits (17.5kHz / 64 = 275Hz)
+uint16_t sine[SAMPLES] = {
+	2048, 2249, 2447, 2642, 2831, 3013, 3185, 3346, 3495, 3630, 3750, 3853, 3939, 4007, 4056, 4085,
+	4095, 4085, 4056, 4007, 3939, 3853, 3750, 3630, 3495, 3346, 3185, 3013, 2831, 2642, 2447, 2249,
+	2048, 1846, 1648, 1453, 1264, 1082,  910,  749,  600,  465,  345,  242,  156,   88,   39,   10,
+	   0,   10,   39,   88,  156,  242,  345,  465,  600,  749,  910, 1082, 1264, 1453, 1648, 1846
+};
+
+AnalogOut aout1(PA_8, TIM1, Channel_1); // RC filter: 1k / 100nF
+
+int main(void)
+{
+	// Repeated waveform, no CPU load
+	aout1.stream(sine, SAMPLES, Dma_Circular, 0);
+
+	while(1)
+	{
+	}
+}
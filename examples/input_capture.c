@@ -0,0 +1,32 @@
+#include "main.h"
+
+#define CAPTURES 32 // Captures per half buffer
+
+uint16_t captures[2 * CAPTURES * 2] = {0};
+uint32_t average = 0;
+uint32_t frequency = 0;
+
+InputCapture tacho(PA_0, TIM2, 1000000); // 1us resolution
+
+void Batch(uint16_t* data, uint16_t count)
+{
+	uint32_t sum = 0;
+	uint16_t i = 0;
+
+	// data[2 x i]: period, data[2 x i + 1]: high time
+	for(i = 0; i < count; i++) sum += data[2 * i];
+
+	average = sum / count;
+}
+
+int main(void)
+{
+	tacho.filter(4);
+	tacho.capture(captures, CAPTURES, &Batch);
+
+	while(1)
+	{
+		frequency = tacho.frequency();
+		Delay(100);
+	}
+}
@@ -0,0 +1,36 @@
+#include "main.h"
+#include <math.h>
+
+#define FREQUENCY 20000 // 20kHz
+#define STEPS     64
+
+PwmOut pwmU(PA_8, FREQUENCY, TIM1, Channel_1);
+PwmOut pwmV(PA_9, FREQUENCY, TIM1, Channel_2);
+PwmOut pwmW(PA_10, FREQUENCY, TIM1, Channel_3);
+
+// Sine table, 16 bits duty cycle
+uint16_t sine[STEPS] = {0};
+
+int main(void)
+{
+	uint8_t i = 0;
+
+	for(i = 0; i < STEPS; i++)
+		sine[i] = 32768 + (int16_t)(32767 * sin(6.283185 * i / STEPS));
+
+	i = 0;
+
+	while(1)
+	{
+		// 3 channels switched on the same PWM period
+		pwmU.hold();
+		pwmU.write_u16(sine[i]);
+		pwmV.write_u16(sine[(i + (STEPS / 3)) % STEPS]);
+		pwmW.write_u16(sine[(i + ((2 * STEPS) / 3)) % STEPS]);
+		pwmU.release();
+
+		i = (i + 1) % STEPS;
+
+		Delay_us(500);
+	}
+}
@@ -0,0 +1,38 @@
+#include "main.h"
+
+#define FREQUENCY 20000 // 20kHz
+#define DEADTIME  500   // 500ns
+
+// Half bridges: PA8/PB13, PA9/PB14, PA10/PB15, center aligned
+PwmComplementary pwmU(PA_8, PB_13, FREQUENCY, Channel_1, DEADTIME, 1);
+PwmComplementary pwmV(PA_9, PB_14, FREQUENCY, Channel_2, DEADTIME, 1);
+PwmComplementary pwmW(PA_10, PB_15, FREQUENCY, Channel_3, DEADTIME, 1);
+
+DigitalOut led(PC_13);
+
+void overcurrent(void)
+{
+	// Outputs already forced low by hardware
+	led = 0;
+}
+
+int main(void)
+{
+	// Over-current comparator on break input (active low)
+	pwmU.fault(PB_12, 0, &overcurrent);
+
+	pwmU.write(25);
+	pwmV.write(50);
+	pwmW.write(75);
+
+	while(1)
+	{
+		if(pwmU.faulted()) {
+			Delay(1000);
+
+			// Restart once the fault is gone
+			pwmU.resume();
+			led = 1;
+		}
+	}
+}
@@ -0,0 +1,51 @@
+#include "main.h"
+
+#define LEDS   8
+#define BITS   (LEDS * 24)
+#define RESET  48 // > 50us low
+
+// WS2812 strip on PA0, 800kHz bitstream
+PwmOut strip(PA_0, 800000, TIM2, Channel_1);
+
+// One compare value per bit, idle low at the end (reset)
+uint16_t frame[BITS + RESET] = {0};
+
+__IO uint8_t done = 1;
+
+void sent(uint16_t* data, uint16_t length)
+{
+	done = 1;
+}
+
+void encode(uint32_t* grb)
+{
+	uint16_t t0h = (strip.period() * 8) / 25;  // 0.4us
+	uint16_t t1h = (strip.period() * 16) / 25; // 0.8us
+	uint16_t i = 0;
+
+	for(i = 0; i < BITS; i++)
+		frame[i] = ((grb[i / 24] >> (23 - (i % 24))) & 0x01) ? t1h : t0h;
+}
+
+int main(void)
+{
+	uint32_t grb[LEDS] = {0};
+	uint8_t step = 0;
+	uint8_t i = 0;
+
+	while(1)
+	{
+		// Moving dot
+		for(i = 0; i < LEDS; i++)
+			grb[i] = (i == (step % LEDS)) ? 0x204010 : 0x000000;
+
+		while(done == 0);
+		done = 0;
+
+		encode(grb);
+		strip.stream(frame, BITS + RESET, Dma_Normal, &sent);
+
+		step++;
+		Delay(100);
+	}
+}
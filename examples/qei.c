@@ -0,0 +1,29 @@
+#include "main.h"
+
+int32_t position = 0;
+int32_t speed = 0;
+
+QEI encoder(PA_6, PA_7, TIM3);
+
+SoftTimer sampler;
+Ticker ticker(TIM4);
+
+void Sample(void* context)
+{
+	encoder.sample();
+}
+
+int main(void)
+{
+	encoder.filter(6);
+
+	// Velocity every 10ms
+	ticker.attach_us(&SoftTimer::tick, 1000);
+	sampler.every(&Sample, 0, 10);
+
+	while(1)
+	{
+		position = encoder.read();
+		speed = encoder.velocity(); // counts/s
+	}
+}
@@ -1,8 +1,8 @@
 #include "main.h"
 
 // Serial port config
-Serial serial(USART1, PA_10, PA_9);
-//Serial serial(USART2, PA_3, PA_2);
+Serial<> serial(USART1, PA_10, PA_9);
+//Serial<> serial(USART2, PA_3, PA_2);
 
 uint8_t buffer[128] = {0};
 uint16_t length = 0;
@@ -0,0 +1,28 @@
+#include "main.h"
+
+// Serial port config
+Serial<> serial(USART1, PA_10, PA_9);
+
+uint8_t buffer[2][128] = {0};
+uint16_t length = 0;
+uint8_t current = 0;
+
+int main(void)
+{
+	serial.baudrate(921600);
+
+	// DMA mode: one interrupt per frame (idle line) instead of one per byte
+	serial.dma();
+
+	while(1)
+	{
+		length = serial.read(buffer[current]);
+
+		// echo mode (buffer shall stay valid until transfer is done)
+		if(length) {
+			while(serial.write(buffer[current], length) == 0);
+
+			current ^= 1;
+		}
+	}
+}
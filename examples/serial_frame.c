@@ -0,0 +1,26 @@
+#include "main.h"
+
+// Serial port config
+Serial<256> serial(USART1, PA_10, PA_9);
+
+uint8_t buffer[128] = {0};
+uint16_t length = 0;
+
+int main(void)
+{
+	serial.baudrate(115200);
+
+	// Line framing: one frame per '\n'
+	serial.frame('\n', 0);
+
+	while(1)
+	{
+		// Complete line ?
+		if(serial.frames()) {
+			length = serial.read_frame(buffer, sizeof(buffer));
+
+			// echo mode
+			serial.write(buffer, length);
+		}
+	}
+}
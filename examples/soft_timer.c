@@ -0,0 +1,36 @@
+#include "main.h"
+
+DigitalOut led1(PC_13);
+DigitalOut led2(PA_8);
+
+Ticker ticker(TIM4);
+
+SoftTimer blink;
+SoftTimer pulse;
+
+void Blink(void* context)
+{
+	led1 = !led1;
+}
+
+void Pulse(void* context)
+{
+	led2 = 0;
+}
+
+int main(void)
+{
+	// 1ms tick for all software timers
+	ticker.attach_us(&SoftTimer::tick, 1000);
+
+	blink.every(&Blink, 0, 500);
+
+	while(1)
+	{
+		// 50ms pulse every second
+		led2 = 1;
+		pulse.once(&Pulse, 0, 50);
+
+		Delay(1000);
+	}
+}
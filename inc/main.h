@@ -10,6 +10,7 @@
 #include "Digital.h"
 #include "Analog.h"
 #include "Timer.h"
+#include "SoftTimer.h"
 #include "Serial.h"
 #include "USB.h"
 
@@ -3,12 +3,51 @@
 
 /* includes ---------------------------------------------------------------- */
 #include "GPIO.h"
+#include "Dma.h"
+#include "Timer.h"
 
 /* defines ----------------------------------------------------------------- */
-#define ADC_CHANNELS_MAX 10
-#define ADC_CHANNEL_GPIOA_OFFSET 0  /* IN[0:7] */
-#define ADC_CHANNEL_GPIOB_OFFSET 8  /* IN[8:9] */
-#define ADC_CHANNEL_GPIOC_OFFSET 14 /* IN[14:15] */
+#define ADC_CHANNELS_MAX 16          /* Regular sequence ranks */
+#define ADC_CHANNEL_GPIOA_OFFSET 0  /* IN[0:7]: PA0-PA7 */
+#define ADC_CHANNEL_GPIOB_OFFSET 8  /* IN[8:9]: PB0-PB1 */
+#define ADC_CHANNEL_GPIOC_OFFSET 10 /* IN[10:15]: PC0-PC5 */
+#define ADC_CHANNEL_NONE         0xFF
+#define ADC_INJECTED_MAX         4
+#define ADC_OVERSAMPLING_MAX     8  /* 2^8 scans per output */
+
+#define ADC_FULL_SCALE           4095
+#define ADC_VDDA_MV              3300 /* Without VREFINT channel */
+#define ADC_VREFINT_MV           1200 /* Typical (1160 to 1240), no factory calibration on F103 */
+#define ADC_TEMP_V25_MV          1430 /* Sensor voltage at 25 degC, typical (1340 to 1520) */
+#define ADC_TEMP_SLOPE_UV        4300 /* uV/degC, typical (4000 to 4600) */
+
+#define ANALOGOUT_RANGE          4096 /* 12 bits, PWM frequency = timer clock / range (72MHz: 17.5kHz) */
+
+/* enum -------------------------------------------------------------------- */
+
+// Sampling time (ADC clock cycles), conversion time = sampling time + 12.5 cycles
+typedef enum {
+	Sample_1_5   = 0x00,
+	Sample_7_5   = 0x01,
+	Sample_13_5  = 0x02,
+	Sample_28_5  = 0x03,
+	Sample_41_5  = 0x04,
+	Sample_55_5  = 0x05,
+	Sample_71_5  = 0x06,
+	Sample_239_5 = 0x07
+} AnalogSampleTime;
+
+// Oversampling filter
+typedef enum {
+	Filter_Boxcar = 0x00, // Moving sum over 2^N scans
+	Filter_Cic    = 0x01  // 2nd order CIC (sinc^2), better alias rejection, 1 output delay
+} AnalogFilter;
+
+// Internal channels (ADC1 only)
+typedef enum {
+	Adc_Temperature = 16,
+	Adc_Vrefint     = 17
+} AnalogInternal;
 
 /* class ------------------------------------------------------------------- */
 class AnalogIn : public GPIO
@@ -17,32 +56,120 @@ class AnalogIn : public GPIO
 		
 		uint8_t m_channel;
 		uint8_t m_rank;
+		uint8_t m_pair;           // ADC2 channel (dual mode)
+		AnalogSampleTime m_sampleTime;
 	
 		static __IO uint8_t m_ranks;
-		static __IO uint16_t m_value[ADC_CHANNELS_MAX];
+		static __IO uint16_t m_value[ADC_CHANNELS_MAX * 2]; // Dual mode: ADC1, ADC2 per rank (4-byte aligned)
+		static uint8_t m_dual;
+		static Dma m_dma;
+	
+		// Block acquisition (double buffer)
+		static uint16_t* m_block;
+		static uint16_t m_blockScans;
+		static void (*m_blockCallback)(uint16_t*, uint16_t);
+	
+		// Injected group
+		static uint16_t m_injected[ADC_INJECTED_MAX];
+		static uint8_t m_injectedCount;
+		static void (*m_injectedCallback)(uint16_t*, uint8_t);
+	
+		// Analog watchdog
+		static void (*m_watchdogCallback)(void);
+	
+		// Oversampling (block acquisition)
+		static uint8_t m_ratio;
+		static uint8_t m_shift;
+		static AnalogFilter m_filter;
+		static uint32_t m_cic[4][ADC_CHANNELS_MAX * 2]; // Integrators, comb delays
+	
+		// Internal channels
+		static uint8_t m_vrefRank;
+		static uint16_t m_vrefint;
+		static uint16_t m_v25;
 		
+		void init(uint8_t channel);
+	
 		static void adc(void);
 		static void dma(void);
+		static void dma_event(void* context, uint8_t events);
+		static void start(void);
+		static void stop(void);
+		static void sequence(ADC_TypeDef* adc, uint8_t rank, uint8_t channel);
+		static void sampling(ADC_TypeDef* adc, uint8_t channel, AnalogSampleTime value);
+		static uint32_t clock(void);
+		static uint16_t decimate(uint16_t* data, uint16_t scans);
 		static void sort(uint8_t* buffer, uint8_t size);
 		static uint8_t channel(PinName pin);
 	
 	public:
 	
 		AnalogIn(PinName pin);
+		AnalogIn(AnalogInternal channel);
 	
 		//uint16_t read_b();
 		uint16_t read();
 		operator uint16_t();	// Read (shorthand)
+	
+		// Millivolts, compensated for supply drift when a VREFINT channel is scanned (snapshot mode)
+		uint16_t read_mv(void);
+		int16_t read_temperature(void);  // Temperature channel: 0.1 degC
+		static uint16_t vdda(void);      // mV
+		static uint16_t millivolts(uint16_t value, uint16_t vref); // Block data: VREFINT sample of the same scan
+		static void calibrate(uint16_t vrefint, uint16_t v25);     // mV, measured VREFINT and sensor voltage at 25 degC
+	
+		uint8_t rank(void);           // Index of the channel in a scan
+		static uint8_t ranks(void);   // Channels per scan
+	
+		// Sampling time (default: 239.5 cycles), shortest one valid for a source impedance (ohms, 12 bits accuracy)
+		void sample_time(AnalogSampleTime value);
+		void impedance(uint32_t ohms);
+		static AnalogSampleTime sample_time_min(uint32_t ohms);
+	
+		// Dual mode (ADC1 + ADC2 regular simultaneous): pin sampled by ADC2 at the same instant
+		// !important: create all AnalogIn objects first
+		void pair(PinName pin);
+		uint16_t read_pair(void);
+	
+		// Block acquisition: buffer holds 2 x scans x ranks() samples, f(data, scans) called from
+		// interrupt when one half is full (data[scan * ranks() + rank()]), the other half being filled.
+		// Dual mode: 2 samples per rank (ADC1, ADC2), buffer twice as large and 4-byte aligned (ignored otherwise).
+		// !important: create all AnalogIn objects first, read() is not updated until block_stop()
+		static void block(uint16_t* buffer, uint16_t scans, void(*f)(uint16_t*, uint16_t));
+		static void block_stop(void);
+	
+		// Timer-triggered scans (TIM1: CC1, TIM2: CC2, TIM3: TRGO, TIM4: CC4), return achieved rate (0: unsupported timer)
+		// !important: scan time (ranks() x conversion time) shall be below 1 / rate
+		static uint32_t trigger(Timer* timer, uint32_t rate);
+		static void trigger_stop(void);                     // Back to continuous conversion
+	
+		// Injected group (up to 4 pins), converted on timer update (TIM1, TIM2, TIM4: TRGO, 0: injected_start()),
+		// interrupting the regular scan. f(values, count) called from interrupt, values in pins order.
+		static uint8_t injected(PinName* pins, uint8_t count, AnalogSampleTime time, Timer* timer, void(*f)(uint16_t*, uint8_t));
+		static void injected_start(void);
+		static void injected_stop(void);
+	
+		// Analog watchdog (12 bits window), f() called from interrupt once out of window, re-armed by watchdog_arm()
+		void watchdog(uint16_t low, uint16_t high, void(*f)(void));            // This channel
+		static void watchdog_all(uint16_t low, uint16_t high, void(*f)(void)); // All regular channels
+		static void watchdog_arm(void);
+		static void watchdog_stop(void);
+	
+		// Oversampling of block acquisition halves (call after block()): 2^ratio scans per output scan,
+		// bits: 12 to 16 (ratio >= 2 x (bits - 12)), block callback gets scans / 2^ratio decimated scans.
+		static uint8_t oversample(uint8_t ratio, AnalogFilter filter, uint8_t bits);
+		static void oversample_stop(void);
+	
+		static void irq(void); // ADC interrupt handler (internal)
 };
 
-class AnalogOut : public GPIO
+// PWM + RC low-pass filter (no DAC on F103x6/x8/xB), ex: 1k/100nF on PA8 (TIM1 CH1)
+// 12 bits PWM (full clock, period: ANALOGOUT_RANGE ticks), stream() samples: 0 to 4095 (see PwmOut)
+class AnalogOut : public PwmOut
 {
-	private:
-	
 	public:
 	
-		AnalogOut(PinName pin);
-	
+		AnalogOut(PinName pin, TIM_TypeDef* timer, TimerChannel channel);
 		void write(uint16_t value);
 		uint16_t read(void);
 		AnalogOut& operator= (uint16_t value);  // Write (shorthand)
@@ -3,27 +3,229 @@
 
 /* includes ----------------------------------------------------------------- */
 #include "GPIO.h"
+#include <string.h>
 
 /* class -------------------------------------------------------------------- */
+
+// Single producer (write index) / single consumer (read index):
+// each side only modifies its own index, no interrupt masking needed.
+// !important: N shall be a power of 2 (32, 64, 128, 256, ...)
+template <typename T, uint16_t N>
 class CircularBuffer
 {
 	private:
 		
-		__IO uint16_t m_read;
-		__IO uint16_t m_write; 
-		__IO uint16_t m_count;
-		__IO uint16_t m_size;
-		__IO uint8_t* m_buffer;
+		typedef char size_check[(((N & (N - 1)) == 0) && (N != 0) && (N <= 0x8000)) ? 1 : -1];
+	
+		__IO uint16_t m_read;  // Consumer index (free running)
+		__IO uint16_t m_write; // Producer index (free running)
+		T m_buffer[N];
+	
+		void resync(void)
+		{
+			// Overrun (DMA): skip overwritten data
+			if((uint16_t)(m_write - m_read) > N)
+				m_read = m_write - N;
+		}
 	
 	public:
 		
-		// !important: buffer size shall be a power of 2 (32, 64, 128, 256, ...)
-		CircularBuffer(uint8_t* buffer, uint16_t size);
+		CircularBuffer(void)
+		{
+			m_read = 0;
+			m_write = 0;
+		}
 		
-		uint16_t count(void);
-		void flush(void);
-		void put(uint8_t c);
-		uint8_t get(void);
+		static uint16_t size(void) { return N; }
+		T* data(void) { return &m_buffer[0]; }
+	
+		uint16_t count(void)
+		{
+			uint16_t count = (uint16_t)(m_write - m_read);
+
+			// Overrun (DMA)
+			if(count > N) count = N;
+
+			return count;
+		}
+	
+		uint16_t space(void)
+		{
+			return (N - this->count());
+		}
+	
+		void flush(void)
+		{
+			// !important: no concurrent access to the buffer
+			m_read = 0;
+			m_write = 0;
+		}
+	
+		// Producer
+		uint8_t put(T c)
+		{
+			uint16_t write = m_write;
+			uint8_t result = 0;
+
+			// Don't overwrite data not yet read !
+			if((uint16_t)(write - m_read) < N) {
+				// Set element
+				m_buffer[write & (N - 1)] = c;
+
+				// Publish element
+				__DMB();
+				m_write = write + 1;
+
+				result = 1;
+			}
+
+			return result;
+		}
+	
+		uint16_t put(const T* buffer, uint16_t length)
+		{
+			uint16_t write = m_write;
+			uint16_t index = write & (N - 1);
+			uint16_t space = N - (uint16_t)(write - m_read);
+			uint16_t first = 0;
+
+			if(length > space) length = space;
+
+			// Copy up to buffer end, then from buffer start
+			first = N - index;
+			if(first > length) first = length;
+
+			memcpy(&m_buffer[index], buffer, first * sizeof(T));
+			memcpy(&m_buffer[0], buffer + first, (length - first) * sizeof(T));
+
+			// Publish data
+			__DMB();
+			m_write = write + length;
+
+			return length;
+		}
+	
+		// Contiguous free space
+		uint16_t reserve(T** data)
+		{
+			uint16_t index = m_write & (N - 1);
+			uint16_t length = N - (uint16_t)(m_write - m_read);
+
+			if(length > (N - index)) length = N - index;
+
+			*data = &m_buffer[index];
+
+			return length;
+		}
+	
+		// Publish data written in place (reserve or DMA)
+		// !important: DMA may overrun, oldest data is then dropped by the reader
+		void commit(uint16_t length)
+		{
+			__DMB();
+			m_write = m_write + length;
+		}
+	
+		// Consumer
+		T get(void)
+		{
+			uint16_t read = 0;
+			T c = T();
+
+			this->resync();
+
+			read = m_read;
+
+			if(m_write != read) {
+				// Get element
+				c = m_buffer[read & (N - 1)];
+
+				// Release element
+				__DMB();
+				m_read = read + 1;
+			}
+
+			return c;
+		}
+	
+		uint16_t get(T* buffer, uint16_t length)
+		{
+			uint16_t read = 0;
+			uint16_t index = 0;
+			uint16_t count = 0;
+			uint16_t first = 0;
+
+			this->resync();
+
+			read = m_read;
+			index = read & (N - 1);
+			count = (uint16_t)(m_write - read);
+
+			if(length > count) length = count;
+
+			// Copy up to buffer end, then from buffer start
+			first = N - index;
+			if(first > length) first = length;
+
+			memcpy(buffer, &m_buffer[index], first * sizeof(T));
+			memcpy(buffer + first, &m_buffer[0], (length - first) * sizeof(T));
+
+			// Release data
+			__DMB();
+			m_read = read + length;
+
+			return length;
+		}
+	
+		// Contiguous data
+		uint16_t peek(T** data)
+		{
+			uint16_t index = 0;
+			uint16_t length = 0;
+
+			this->resync();
+
+			index = m_read & (N - 1);
+			length = (uint16_t)(m_write - m_read);
+
+			if(length > (N - index)) length = N - index;
+
+			*data = &m_buffer[index];
+
+			return length;
+		}
+	
+		// Data in up to 2 contiguous regions (wrap)
+		uint16_t peek(T* data[2], uint16_t length[2])
+		{
+			uint16_t index = 0;
+			uint16_t count = 0;
+
+			this->resync();
+
+			index = m_read & (N - 1);
+			count = (uint16_t)(m_write - m_read);
+
+			length[0] = count;
+			if(length[0] > (N - index)) length[0] = N - index;
+			length[1] = count - length[0];
+
+			data[0] = &m_buffer[index];
+			data[1] = &m_buffer[0];
+
+			return count;
+		}
+	
+		// Release data read in place
+		void skip(uint16_t length)
+		{
+			uint16_t count = this->count();
+
+			if(length > count) length = count;
+
+			__DMB();
+			m_read = m_read + length;
+		}
 };
 
 #endif /* __CIRCULARBUFFER_H */
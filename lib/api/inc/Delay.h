@@ -5,6 +5,7 @@
 #include "stm32f1xx_it.h"
 
 /* functions ---------------------------------------------------------------- */
-void Delay(uint32_t value);
+void Delay(uint32_t value);    // ms
+void Delay_us(uint32_t value); // us
 
 #endif /* __DELAY_H */
@@ -0,0 +1,123 @@
+#ifndef __DMA_H
+#define __DMA_H
+
+/* includes ---------------------------------------------------------------- */
+#include "Common.h"
+
+/* defines ----------------------------------------------------------------- */
+#define DMA_CHANNELS 7
+
+/* enum -------------------------------------------------------------------- */
+
+// DMA1 requests (RM0008 table 78): channel (bits 0-3), request (bits 8-11)
+typedef enum {
+	Dma_ADC1      = 0x0001,
+	Dma_TIM2_CH3  = 0x0101,
+	Dma_TIM4_CH1  = 0x0201,
+
+	Dma_SPI1_RX   = 0x0002,
+	Dma_USART3_TX = 0x0102,
+	Dma_TIM1_CH1  = 0x0202,
+	Dma_TIM2_UP   = 0x0302,
+	Dma_TIM3_CH3  = 0x0402,
+
+	Dma_SPI1_TX   = 0x0003,
+	Dma_USART3_RX = 0x0103,
+	Dma_TIM1_CH2  = 0x0203,
+	Dma_TIM3_CH4  = 0x0303,
+	Dma_TIM3_UP   = 0x0403,
+
+	Dma_SPI2_RX   = 0x0004,
+	Dma_USART1_TX = 0x0104,
+	Dma_I2C2_TX   = 0x0204,
+	Dma_TIM1_CH4  = 0x0304,
+	Dma_TIM1_TRIG = 0x0404,
+	Dma_TIM1_COM  = 0x0504,
+	Dma_TIM4_CH2  = 0x0604,
+
+	Dma_SPI2_TX   = 0x0005,
+	Dma_USART1_RX = 0x0105,
+	Dma_I2C2_RX   = 0x0205,
+	Dma_TIM1_UP   = 0x0305,
+	Dma_TIM2_CH1  = 0x0405,
+	Dma_TIM4_CH3  = 0x0505,
+
+	Dma_USART2_RX = 0x0006,
+	Dma_I2C1_TX   = 0x0106,
+	Dma_TIM1_CH3  = 0x0206,
+	Dma_TIM3_CH1  = 0x0306,
+	Dma_TIM3_TRIG = 0x0406,
+
+	Dma_USART2_TX = 0x0007,
+	Dma_I2C1_RX   = 0x0107,
+	Dma_TIM2_CH2  = 0x0207,
+	Dma_TIM2_CH4  = 0x0307,
+	Dma_TIM4_UP   = 0x0407
+} DmaRequest;
+
+typedef enum {
+	Dma_PeripheralToMemory = 0x00,
+	Dma_MemoryToPeripheral = 0x01
+} DmaDirection;
+
+typedef enum {
+	Dma_8bits  = 0x00,
+	Dma_16bits = 0x01,
+	Dma_32bits = 0x02
+} DmaSize;
+
+typedef enum {
+	Dma_Low      = 0x00,
+	Dma_Medium   = 0x01,
+	Dma_High     = 0x02,
+	Dma_VeryHigh = 0x03
+} DmaPriority;
+
+typedef enum {
+	Dma_Normal       = 0x00, // Single transfer
+	Dma_Circular     = 0x01, // Restart on completion
+	Dma_DoubleBuffer = 0x02  // Circular on 2 x length, half: first buffer ready, complete: second buffer ready
+} DmaMode;
+
+typedef enum {
+	Dma_Complete = 0x01,
+	Dma_Half     = 0x02,
+	Dma_Error    = 0x04
+} DmaEvent;
+
+/* class ------------------------------------------------------------------- */
+
+// !important: no constructor, the object shall be zero-initialized
+// (static object or value-initialized member) so it can be used before
+// static constructors have run.
+class Dma
+{
+	private:
+	
+		DMA_Channel_TypeDef* m_channel;
+		uint8_t m_index;
+		uint8_t m_mode;
+	
+		void (*m_callback)(void*, uint8_t);
+		void* m_context;
+	
+	public:
+	
+		static uint8_t channel(DmaRequest request);
+	
+		uint8_t open(DmaRequest request, DmaDirection direction, DmaSize size, DmaPriority priority);
+		void close(void);
+		uint8_t opened(void);
+	
+		void attach(void(*f)(void*, uint8_t), void* context); // f(context, events), called from interrupt
+		void detach(void);
+	
+		void start(volatile void* peripheral, void* memory, uint16_t length, DmaMode mode);
+		void stop(void);
+		uint16_t remaining(void);
+		uint8_t busy(void);
+	
+		void irq(void); // DMA interrupt handler (internal)
+};
+
+#endif /* __DMA_H */
@@ -17,11 +17,8 @@ class I2C
 		GPIO m_sda;
 		GPIO m_scl;
 	
-		uint8_t m_bufferRx[I2C_BUFFER_SIZE];
-		uint8_t m_bufferTx[I2C_BUFFER_SIZE];
-	
-		CircularBuffer m_circularRx;
-		CircularBuffer m_circularTx;
+		CircularBuffer<uint8_t, I2C_BUFFER_SIZE> m_circularRx;
+		CircularBuffer<uint8_t, I2C_BUFFER_SIZE> m_circularTx;
 		
 	public:
 		
@@ -4,39 +4,146 @@
 /* includes ----------------------------------------------------------------- */
 #include "GPIO.h"
 #include "CircularBuffer.h"
+#include "Dma.h"
 
 /* defines ------------------------------------------------------------------ */
 #define USART_BAUDRATE_DEFAULT   (9600)
-#define USART_BUFFER_SIZE        (128) // !important: shall be a power of 2 (32, 64, 128, 256, ...)
+#define USART_BUFFER_SIZE        (128) // !important: shall be a power of 2 (16 to 1024)
+#define USART_FRAMES_MAX         (16)  // !important: shall be a power of 2
+
+/* struct ------------------------------------------------------------------- */
+typedef struct {
+	uint8_t* data[2];   // Rx buffer regions (second one used on wrap)
+	uint16_t length[2];
+} SerialSpan;
+
+typedef struct {
+	uint32_t overrun;
+	uint32_t framing;
+	uint32_t noise;
+	uint32_t parity;
+	uint32_t dropped;   // Rx buffer full
+} SerialStats;
 
 /* class -------------------------------------------------------------------- */
-class Serial
+class SerialBase
 {
-	private:
+	protected:
 		
 		USART_TypeDef* m_usart;
 		
 		GPIO m_rx;
 		GPIO m_tx;
+		GPIO m_rts;
+		GPIO m_cts;
+		GPIO m_de;
+		GPIO m_ck;
 
 		uint32_t m_baudrate;
-		
-		uint8_t m_bufferRx[USART_BUFFER_SIZE];
-		uint8_t m_bufferTx[USART_BUFFER_SIZE];
 	
-		CircularBuffer m_circularRx;
-		CircularBuffer m_circularTx;
+		// DMA mode
+		Dma m_dmaRx;
+		Dma m_dmaTx;
+	
+		uint16_t m_dmaRxPosition;
+	
+		__IO uint8_t m_idle;
+	
+		// Tx watermark callback
+		void (*m_txCallback)(void);
+		uint16_t m_txWatermark;
+	
+		SerialStats m_stats;
+	
+		uint8_t m_halfDuplex;
 	
 		static void pin(GPIO* gpio);
+		static void dma_rx_event(void* context, uint8_t events);
+		static void dma_tx_event(void* context, uint8_t events);
+	
+		uint32_t clock(void);
+		uint16_t divider(uint32_t value);
+	
+		SerialBase(USART_TypeDef* usart, PinName rx, PinName tx);
+		void link(void);
+		void dma_open(void);
+		void dma_start(uint8_t* buffer, uint16_t size);
+		uint16_t dma_write(uint8_t* buffer, uint16_t length);
+		void drive(void);
+		void turnaround_arm(void);
+		void turnaround(void);
 	
 	public:
 		
-		Serial(USART_TypeDef* usart, PinName rx, PinName tx);
-		
 		void baudrate(uint32_t value);
+		uint32_t baudrate_achieved(void);
+		int32_t baudrate_error(void);    // ppm
 		void format(uint8_t databits, SerialParity parity, uint8_t stopbits);
-		uint8_t write(uint8_t* buffer, uint16_t length);
-		uint16_t read(uint8_t* buffer);
+	
+		void attach_tx(void(*f)(void), uint16_t watermark);
+		void detach_tx(void);
+	
+		// Flow control: RTS driven by Rx buffer fill level, CTS by hardware (NC: disabled)
+		void flow(PinName rts, PinName cts);
+	
+		// Half-duplex single wire on Tx pin (open-drain), DE: RS-485 driver enable, pull-up on the
+		// DI/RO line (NC: open-drain bus, external pull-up)
+		void half_duplex(PinName de);
+	
+		// Synchronous master, CK (USART1: PA8, USART2: PA4), clock polarity/phase: 0 or 1
+		void synchronous(PinName ck, uint8_t cpol, uint8_t cpha);
+	
+		SerialStats stats(void);
+		void stats_reset(void);
+	
+		// Reprogram all ports after a system clock change (SystemCoreClock and RCC->CFGR updated),
+		// !important: not called by the library, call it once the new clock tree is running
+		static void clock_update(void);
+	
+		virtual void irq(void) = 0;     // USART interrupt handler (internal)
+		virtual void irq_dma(void) = 0; // DMA Rx half/full transfer handler (internal)
+};
+
+// Buffer size per port, ex: Serial<1024> telemetry(USART1, PA_10, PA_9);
+// !important: SIZE shall be a power of 2 (16 to 1024)
+template <uint16_t SIZE = USART_BUFFER_SIZE>
+class Serial : public SerialBase
+{
+	private:
+	
+		CircularBuffer<uint8_t, SIZE> m_circularRx;
+		CircularBuffer<uint8_t, SIZE> m_circularTx;
+	
+		// Framing mode (frame lengths, delimiter included)
+		CircularBuffer<uint16_t, USART_FRAMES_MAX> m_frames;
+	
+		uint8_t m_frameEnabled;
+		uint8_t m_frameDelimiter;
+		uint16_t m_frameLength;
+		void (*m_frameCallback)(void);
+	
+		void dma_rx(void);
+		void flow_rx(void);
+		void frame_byte(uint8_t c);
+	
+	public:
+		
+		Serial(USART_TypeDef* usart, PinName rx, PinName tx);
+		
+		void dma(void);
+		uint16_t write(uint8_t* buffer, uint16_t length); // !important: DMA mode, buffer shall stay valid until transfer is done
+		uint16_t writeable(void);
+		uint16_t read(uint8_t* buffer);                   // !important: buffer shall hold SIZE bytes
+		uint16_t read_span(SerialSpan* span);             // Zero-copy read, release with consume()
+		void consume(uint16_t length);
+	
+		// Framing mode (ex: '\n', 0x7E, 0x00 for COBS), !important: use read_frame() instead of read()
+		void frame(uint8_t delimiter, void(*f)(void));
+		uint16_t frames(void);
+		uint16_t read_frame(uint8_t* buffer, uint16_t length);
+	
+		void irq(void);
+		void irq_dma(void);
 };
 
 #endif /* __SERIAL_H */
@@ -0,0 +1,51 @@
+#ifndef __SOFTTIMER_H
+#define __SOFTTIMER_H
+
+/* includes ---------------------------------------------------------------- */
+#include "Common.h"
+
+/* defines ----------------------------------------------------------------- */
+#define SOFTTIMER_LEVELS     4  /* Wheel levels, 2^(6 x 4) ticks span before re-cascading */
+#define SOFTTIMER_SLOT_BITS  6
+#define SOFTTIMER_SLOTS      (1 << SOFTTIMER_SLOT_BITS)
+#define SOFTTIMER_SLOT_MASK  (SOFTTIMER_SLOTS - 1)
+
+/* class ------------------------------------------------------------------- */
+
+// Software timers multiplexed on one periodic tick (hierarchical timing wheel, O(1) start/cancel),
+// ex: Ticker ticker(TIM4); ticker.attach_us(&SoftTimer::tick, 1000); (1ms tick)
+class SoftTimer
+{
+	private:
+	
+		SoftTimer* m_next;
+		SoftTimer** m_pprev;      // Previous next pointer (0: not queued)
+	
+		uint32_t m_expires;       // Tick
+		uint32_t m_period;        // Ticks (0: one shot)
+	
+		void (*m_callback)(void*);
+		void* m_context;
+	
+		static SoftTimer* m_wheel[SOFTTIMER_LEVELS][SOFTTIMER_SLOTS];
+		static __IO uint32_t m_now;
+	
+		static void insert(SoftTimer* timer);
+		static void remove(SoftTimer* timer);
+		static void cascade(uint8_t level, uint8_t slot);
+	
+	public:
+	
+		SoftTimer();
+	
+		// f(context) called from the tick interrupt after ticks (>= 1), once or every ticks
+		void once(void(*f)(void*), void* context, uint32_t ticks);
+		void every(void(*f)(void*), void* context, uint32_t ticks);
+		void cancel(void);
+		uint8_t active(void);
+	
+		static void tick(void);   // Periodic tick (timer update or SysTick interrupt)
+		static uint32_t now(void);
+};
+
+#endif /* __SOFTTIMER_H */
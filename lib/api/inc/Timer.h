@@ -4,10 +4,10 @@
 /* includes ---------------------------------------------------------------- */
 #include "Common.h"
 #include "GPIO.h"
+#include "Dma.h"
 
 /* defines ----------------------------------------------------------------- */
 #define PWMOUT_DUTYCYCLE_MAX 100 
-#define PWMOUT_LOW_FREQUENCY 800
 
 /* class ------------------------------------------------------------------- */
 class Timer
@@ -16,18 +16,33 @@ class Timer
 		
 		TIM_TypeDef* m_timer;
 	
+		uint64_t m_start;     // SysTick_Micros() at start() or reset()
+		uint64_t m_elapsed;   // Microseconds counted before the last stop()
+	
+		uint64_t elapsed(void);
+		uint32_t clock(void);
+		uint32_t setup(uint32_t frequency); // PSC/ARR for an update frequency, return achieved frequency
+	
 	public:
 		
 		Timer(TIM_TypeDef* timer);
 		void start(void);
 		void stop(void);
 		void reset(void);
+		// Time counted while started (SysTick_Micros(), no 16 bits counter wrap)
 		uint32_t read(void);
 		uint32_t read_ms(void);
 		uint32_t read_us(void);
 	
 		void attach(void(*f)(void));
 		void detach(void);
+	
+		// Periodic trigger output (TRGO on update, optional compare event on channel), return achieved frequency
+		void trigger(void);                   // Period unchanged (ex: PWM timer)
+		uint32_t trigger(uint32_t frequency);
+		uint32_t trigger(uint32_t frequency, TimerChannel channel);
+	
+		TIM_TypeDef* timer(void);
 };
 
 class Ticker : public Timer
@@ -56,22 +71,145 @@ class Timeout : public Timer
 
 class PwmOut : public GPIO, public Timer
 {
-	private:
+	protected:
 		
 		TIM_TypeDef* m_timer;
 	
-		uint32_t m_frequency;
-		uint8_t m_dutyCycle;
+		uint16_t m_duty;          // 0 to 65535
 		TimerChannel m_channel;
+		__IO uint32_t* m_ccr;
+	
+		// Streaming mode
+		Dma m_dma;
+		void (*m_callback)(uint16_t*, uint16_t);
+		uint16_t* m_buffer;
+		uint16_t m_length;
+		DmaMode m_mode;
+	
+		static void dma_event(void* context, uint8_t events);
 	
 	public:
 		
 		PwmOut(PinName pin, uint32_t frequency, TIM_TypeDef* timer, TimerChannel channel);
-		void frequency(uint32_t value);     // Modify frequency
-		void write(uint8_t value);          // Write
+		void frequency(uint32_t value);     // Modify frequency (all timer channels, duty cycles kept)
+		uint32_t frequency(void);           // Achieved frequency
+		void write(uint8_t value);          // Write (percent)
+		void write_u16(uint16_t value);     // Write (0 to 65535, timer resolution)
 		PwmOut& operator= (uint8_t value);  // Write (shorthand)
-		uint8_t read();                     // Read
+		uint8_t read();                     // Read (percent)
+		uint16_t read_u16(void);
 		operator uint8_t();
+	
+		// Synchronized update of several channels of the timer (ex: 3-phase), applied on the same period
+		void hold(void);
+		void release(void);
+	
+		// Compare values from buffer (0 to period(), timer ticks), one per PWM period via timer update DMA
+		// (ex: WS2812 bitstream, servo train), Dma_Normal: once (end buffer with the idle value),
+		// Dma_Circular: repeated, Dma_DoubleBuffer: 2 x length values, f(data, length) called from interrupt
+		// when a half has been played (encode next frame). Return 0: DMA channel already used.
+		// !important: one streaming channel per timer
+		uint8_t stream(uint16_t* buffer, uint16_t length, DmaMode mode, void(*f)(uint16_t*, uint16_t));
+		void stream_stop(void);
+		uint8_t streaming(void);
+		uint32_t period(void);              // Compare value for 100% (timer ticks)
+};
+
+// TIM1 channel 1 to 3 with complementary output (CH1/CH1N: PA8/PB13, CH2/CH2N: PA9/PB14, CH3/CH3N: PA10/PB15),
+// dead-time shared by all channels, center-aligned (0: edge aligned, 1: center aligned, frequency kept)
+// set by the first channel, !important: Channel_4 rejected (no complementary output, pins left floating)
+class PwmComplementary : public PwmOut
+{
+	private:
+	
+		GPIO m_outN;
+		GPIO m_break;
+		uint8_t m_center;
+	
+		static uint8_t dtg(uint32_t clock, uint32_t ns);
+	
+	public:
+	
+		PwmComplementary(PinName pin, PinName pinN, uint32_t frequency, TimerChannel channel, uint32_t deadtime, uint8_t center);
+		void frequency(uint32_t value);
+		uint32_t frequency(void);           // Achieved frequency (PWM period)
+		uint32_t deadtime(uint32_t ns);     // Return applied dead-time (ns)
+	
+		// Break input (PB12), level: active level (0: low, 1: high), f() called from interrupt on fault,
+		// outputs forced to idle (low) by hardware until resume()
+		void fault(PinName pin, uint8_t level, void(*f)(void));
+		uint8_t faulted(void);
+		void resume(void);
+};
+
+// PWM input on channel 1 (TIM1: PA8, TIM2: PA0, TIM3: PA6, TIM4: PB6), counter reset on each rising edge,
+// CCR1: period, CCR2: high time, in ticks of clock (Hz, ex: 1000000 for 1us, period up to 65535 ticks)
+class InputCapture : public GPIO, public Timer
+{
+	private:
+	
+		uint32_t m_clock;
+		Dma m_dma;
+	
+		void (*m_callback)(uint16_t*, uint16_t);
+		uint16_t* m_buffer;
+		uint16_t m_captures;
+	
+		static void dma_event(void* context, uint8_t events);
+	
+	public:
+	
+		InputCapture(PinName pin, TIM_TypeDef* timer, uint32_t clock);
+		void filter(uint8_t value);         // Input filter (0: none to 15: fDTS / 32, N = 8)
+	
+		// Latest capture (ticks)
+		uint16_t period(void);
+		uint16_t width(void);
+		uint32_t frequency(void);           // Hz
+		uint16_t duty(void);                // 0 to 65535
+	
+		// Every capture moved by DMA (CCR1/CCR2 burst), buffer holds 2 x captures x {period, width},
+		// f(data, captures) called from interrupt when a half is full. Return 0: DMA channel already used.
+		uint8_t capture(uint16_t* buffer, uint16_t captures, void(*f)(uint16_t*, uint16_t));
+		void capture_stop(void);
+};
+
+// Quadrature encoder on channels 1 and 2 (TIM1: PA8/PA9, TIM2: PA0/PA1, TIM3: PA6/PA7, TIM4: PB6/PB7),
+// 4 counts per encoder period, counter extended from the signed difference between successive reads,
+// sampled by interrupt at least every third of the 16 bits range (update, CC3 and CC4 compare)
+// !important: channels 3 and 4 of the timer not available
+class QEI : public Timer
+{
+	private:
+	
+		GPIO m_a;
+		GPIO m_b;
+	
+		int64_t m_count;          // Extended count
+		uint16_t m_last;          // Counter at last sample
+	
+		int64_t m_sample;         // Velocity snapshot
+		uint64_t m_sampleTime;
+		int32_t m_velocity;
+	
+		static QEI* m_qei[4];
+	
+		template <uint8_t N>
+		static void update(void);
+		void extend(void);
+	
+	public:
+	
+		QEI(PinName a, PinName b, TIM_TypeDef* timer);
+		void filter(uint8_t value);         // Input filter (0: none to 15: fDTS / 32, N = 8)
+		void reset(void);
+	
+		int32_t read(void);
+		int64_t read64(void);
+	
+		// Periodic snapshot (ex: SoftTimer every 10ms), velocity in counts per second between the last two
+		void sample(void);
+		int32_t velocity(void);
 };
 
 #endif /* __TIMER_H */
@@ -12,19 +12,50 @@
 #include "Analog.h"
 
 __IO uint8_t AnalogIn::m_ranks = 0;
-__IO uint16_t AnalogIn::m_value[ADC_CHANNELS_MAX] = {0};
+__IO uint16_t AnalogIn::m_value[ADC_CHANNELS_MAX * 2] __ALIGNED(4) = {0}; // Dual mode: 32 bits DMA transfers
+uint8_t AnalogIn::m_dual = 0;
+Dma AnalogIn::m_dma;
+uint16_t* AnalogIn::m_block = 0;
+uint16_t AnalogIn::m_blockScans = 0;
+void (*AnalogIn::m_blockCallback)(uint16_t*, uint16_t) = 0;
+uint16_t AnalogIn::m_injected[ADC_INJECTED_MAX] = {0};
+uint8_t AnalogIn::m_injectedCount = 0;
+void (*AnalogIn::m_injectedCallback)(uint16_t*, uint8_t) = 0;
+void (*AnalogIn::m_watchdogCallback)(void) = 0;
+uint8_t AnalogIn::m_ratio = 0;
+uint8_t AnalogIn::m_shift = 0;
+AnalogFilter AnalogIn::m_filter = Filter_Boxcar;
+uint32_t AnalogIn::m_cic[4][ADC_CHANNELS_MAX * 2] = {{0}};
+uint8_t AnalogIn::m_vrefRank = ADC_CHANNEL_NONE;
+uint16_t AnalogIn::m_vrefint = ADC_VREFINT_MV;
+uint16_t AnalogIn::m_v25 = ADC_TEMP_V25_MV;
 
 AnalogIn :: AnalogIn(PinName pin) : GPIO(pin, Pin_AN)
 {
-	// ADC up ?
-	if((ADC1->CR2 & ADC_CR2_ADON) != 0) {
-		// Stop ADC/conversion
-		ADC1->CR2 &= ~ADC_CR2_ADON;
+	this->init(AnalogIn::channel(pin));
+}
 
-		// Wait ADC
-		while((ADC1->CR2 & ADC_CR2_ADON) != 0);
+AnalogIn :: AnalogIn(AnalogInternal channel) : GPIO(NC, Pin_AN)
+{
+	this->init((uint8_t)channel);
+}
+
+void AnalogIn :: init(uint8_t channel)
+{
+	m_channel = channel;
+	m_rank = 0;
+	m_pair = ADC_CHANNEL_NONE;
+	m_sampleTime = Sample_239_5;
+
+	// Not an analog pin or sequence full ?
+	if((m_channel == ADC_CHANNEL_NONE) || (m_ranks >= ADC_CHANNELS_MAX)) {
+		m_channel = ADC_CHANNEL_NONE;
+		return;
 	}
 
+	// Stop ADC/conversion
+	AnalogIn::stop();
+
 	// ADC configuration needed ?
 	if(ADC1->CR2 == 0) {
 		// DMA access: disable
@@ -32,9 +63,6 @@ AnalogIn :: AnalogIn(PinName pin) : GPIO(pin, Pin_AN)
 
 		AnalogIn::adc();
 	}
-	
-	// Get ADC channel
-	m_channel = AnalogIn::channel(pin);
 
 	// Store channel index
 	m_rank = m_ranks++;
@@ -44,35 +72,34 @@ AnalogIn :: AnalogIn(PinName pin) : GPIO(pin, Pin_AN)
 
 	// Channel configuration
 
+	// Temperature sensor and VREFINT: enabled
+	if(m_channel >= Adc_Temperature)
+		ADC1->CR2 |= ADC_CR2_TSVREFE;
+
+	// Supply reference for millivolts conversion
+	if(m_channel == Adc_Vrefint)
+		m_vrefRank = m_rank;
+
 	// Regular sequence configuration
-	if(m_ranks <= 7) {
-		ADC1->SQR3 |= (m_channel << (m_rank * 5));
-	} else if(m_ranks <= 13) {
-		ADC1->SQR2 |= (m_channel << ((m_rank - 7) * 5));
-	} else {
-		ADC1->SQR1 |= (m_channel << ((m_rank - 13) * 5));
-	}
+	AnalogIn::sequence(ADC1, m_rank, m_channel);
 
 	// Set the number of channels to convert
 	ADC1->SQR1 &= ~ADC_SQR1_L;
 	ADC1->SQR1 |= ((m_ranks - 1) << ADC_SQR1_L_Pos);
 
+	// Dual mode: same sequence length on ADC2
+	if(m_dual != 0) {
+		ADC2->SQR1 &= ~ADC_SQR1_L;
+		ADC2->SQR1 |= ((m_ranks - 1) << ADC_SQR1_L_Pos);
+	}
+
 	// Channel sampling time configuration (239.5 ADC clock cycles)
-	if(m_channel >= 10)
-		ADC1->SMPR1 |= (ADC_SMPR1_SMP10 << ((m_channel - 10) * 3));
-	else
-		ADC1->SMPR2 |= (ADC_SMPR2_SMP0 << (m_channel * 3));
+	AnalogIn::sampling(ADC1, m_channel, m_sampleTime);
 
 	// Conversion time = (239.5 + 12.5) x (1 / 8MHz) = 31us
 
-	// Enable ADC
-	ADC1->CR2 |= ADC_CR2_ADON;
-
-	// Wait ADC
-	while((ADC1->CR2 & ADC_CR2_ADON) == 0);
-	
 	// Start conversion
-	ADC1->CR2 |= ADC_CR2_SWSTART;
+	AnalogIn::start();
 }
 
 void AnalogIn :: adc(void)
@@ -93,11 +120,11 @@ void AnalogIn :: adc(void)
 	// Scan mode: enabled
 	ADC1->CR1 |= ADC_CR1_SCAN;
 
-	// End Of Sequence conversion Interrupt (EOSI): enabled
-	ADC1->CR1 |= ADC_CR1_EOSIE;
+	// End Of Conversion Interrupt: disabled (regular results moved by DMA)
 
 	// Conversion mode: continuous
 	ADC1->CR2 |= ADC_CR2_CONT;
+	if(m_dual != 0) ADC2->CR2 |= ADC_CR2_CONT;
 
 	// DMA access: enable (only ADC1)
 	ADC1->CR2 |= ADC_CR2_DMA;
@@ -105,63 +132,568 @@ void AnalogIn :: adc(void)
 	// ADC start: software event
 	ADC1->CR2 |= (ADC_CR2_EXTTRIG | ADC_CR2_EXTSEL_0 | ADC_CR2_EXTSEL_1 | ADC_CR2_EXTSEL_2);
 
-	// NVIC configuration
-//	NVIC_SetPriority(ADC1_2_IRQn, 1); // High: 0, Low: 3
-//	NVIC_EnableIRQ(ADC1_2_IRQn);
+	// Injected group start: software event
+	ADC1->CR2 |= (ADC_CR2_JEXTTRIG | ADC_CR2_JEXTSEL_0 | ADC_CR2_JEXTSEL_1 | ADC_CR2_JEXTSEL_2);
+
+	// NVIC configuration (injected group, analog watchdog)
+	NVIC_SetPriority(ADC1_2_IRQn, 0); // High: 0, Low: 3
+	NVIC_EnableIRQ(ADC1_2_IRQn);
 }
 
 void AnalogIn :: dma(void)
 {
-	// Disable DMA1 channel
-	DMA1_Channel1->CCR &= (uint16_t)(~DMA_CCR_EN);
+	// DMA1 channel1: ADC1, 16 bits, high priority
+	// Dual mode: ADC2 data in DR upper half, 32 bits
+	if(m_dma.open(Dma_ADC1, Dma_PeripheralToMemory, (m_dual != 0) ? Dma_32bits : Dma_16bits, Dma_High) == 0) return;
+
+	if(m_block != 0) {
+		// Block acquisition: half/full transfer interrupt
+		m_dma.attach(&AnalogIn::dma_event, 0);
+		m_dma.start(&ADC1->DR, m_block, m_blockScans * m_ranks, Dma_DoubleBuffer);
+	} else {
+		// Circular transfer of all ranks
+		m_dma.detach();
+		m_dma.start(&ADC1->DR, (void*)&m_value[0], m_ranks, Dma_Circular);
+	}
+}
+
+void AnalogIn :: dma_event(void* context, uint8_t events)
+{
+	uint16_t length = (m_blockScans * m_ranks) << m_dual;
+	uint16_t scans = 0;
+
+	(void)context;
+
+	// First half ready (second one being filled)
+	if((events & Dma_Half) != 0) {
+		scans = AnalogIn::decimate(&m_block[0], m_blockScans);
+
+		if(m_blockCallback != 0) (*m_blockCallback)(&m_block[0], scans);
+	}
+
+	// Second half ready (first one being filled)
+	if((events & Dma_Complete) != 0) {
+		scans = AnalogIn::decimate(&m_block[length], m_blockScans);
+
+		if(m_blockCallback != 0) (*m_blockCallback)(&m_block[length], scans);
+	}
+}
+
+uint16_t AnalogIn :: decimate(uint16_t* data, uint16_t scans)
+{
+	static uint32_t sum[ADC_CHANNELS_MAX * 2];
+
+	uint8_t width = m_ranks << m_dual;
+	uint16_t ratio = (1 << m_ratio);
+	uint16_t* in = data;
+	uint32_t comb = 0;
+	uint16_t k = 0;
+	uint16_t j = 0;
+	uint8_t c = 0;
+
+	// Oversampling disabled ?
+	if(m_ratio == 0) return scans;
+
+	// Output k written in place once input scans k x ratio to (k + 1) x ratio - 1 are read
+	for(k = 0; k < (scans >> m_ratio); k++) {
+		if(m_filter == Filter_Boxcar) {
+			for(c = 0; c < width; c++) sum[c] = 0;
+
+			for(j = 0; j < ratio; j++) {
+				for(c = 0; c < width; c++) sum[c] += in[c];
+				in += width;
+			}
+		} else {
+			// Integrators (input rate, modulo 2^32)
+			for(j = 0; j < ratio; j++) {
+				for(c = 0; c < width; c++) {
+					m_cic[0][c] += in[c];
+					m_cic[1][c] += m_cic[0][c];
+				}
+				in += width;
+			}
+
+			// Combs (output rate)
+			for(c = 0; c < width; c++) {
+				comb = m_cic[1][c] - m_cic[2][c];
+				m_cic[2][c] = m_cic[1][c];
+
+				sum[c] = comb - m_cic[3][c];
+				m_cic[3][c] = comb;
+			}
+		}
+
+		for(c = 0; c < width; c++)
+			data[(k * width) + c] = (uint16_t)(sum[c] >> m_shift);
+	}
+
+	return (scans >> m_ratio);
+}
+
+void AnalogIn :: start(void)
+{
+	// Dual mode: enable ADC2 first (slave)
+	if(m_dual != 0) {
+		ADC2->CR2 |= ADC_CR2_ADON;
+
+		// Wait ADC
+		while((ADC2->CR2 & ADC_CR2_ADON) == 0);
+	}
+
+	// Enable ADC
+	ADC1->CR2 |= ADC_CR2_ADON;
+
+	// Wait ADC
+	while((ADC1->CR2 & ADC_CR2_ADON) == 0);
+	
+	// Start conversion (regular sequence)
+	if(m_ranks != 0) ADC1->CR2 |= ADC_CR2_SWSTART;
+}
+
+void AnalogIn :: stop(void)
+{
+	// ADC up ?
+	if((ADC1->CR2 & ADC_CR2_ADON) != 0) {
+		// Stop ADC/conversion
+		ADC1->CR2 &= ~ADC_CR2_ADON;
+
+		// Wait ADC
+		while((ADC1->CR2 & ADC_CR2_ADON) != 0);
+	}
+
+	// Dual mode: stop ADC2
+	if((m_dual != 0) && ((ADC2->CR2 & ADC_CR2_ADON) != 0)) {
+		ADC2->CR2 &= ~ADC_CR2_ADON;
+
+		// Wait ADC
+		while((ADC2->CR2 & ADC_CR2_ADON) != 0);
+	}
+}
+
+void AnalogIn :: block(uint16_t* buffer, uint16_t scans, void(*f)(uint16_t*, uint16_t))
+{
+	if((buffer == 0) || (scans == 0) || (m_ranks == 0)) return;
+
+	// DMA transfer count limit (both halves, dual mode: 1 transfer per rank)
+	if(((uint32_t)scans * m_ranks * 2) > 0xFFFF) return;
+
+	// Dual mode: 32 bits DMA transfers (memory address bits [1:0] ignored)
+	if((m_dual != 0) && (((uint32_t)(uintptr_t)buffer & 0x03) != 0)) return;
+
+	// Stop ADC so the first sample lands on rank 0
+	AnalogIn::stop();
+
+	m_block = buffer;
+	m_blockScans = scans;
+	m_blockCallback = f;
+
+	AnalogIn::dma();
+	AnalogIn::start();
+}
+
+void AnalogIn :: block_stop(void)
+{
+	AnalogIn::stop();
+
+	m_block = 0;
+	m_blockCallback = 0;
+
+	// Back to snapshot mode
+	AnalogIn::dma();
+	AnalogIn::start();
+}
+
+uint8_t AnalogIn :: injected(PinName* pins, uint8_t count, AnalogSampleTime time, Timer* timer, void(*f)(uint16_t*, uint8_t))
+{
+	uint32_t jextsel = (ADC_CR2_JEXTSEL_0 | ADC_CR2_JEXTSEL_1 | ADC_CR2_JEXTSEL_2);
+	uint32_t jsqr = 0;
+	uint8_t channel = 0;
+	uint8_t i = 0;
+
+	if((count == 0) || (count > ADC_INJECTED_MAX)) return 0;
+
+	// ADC1 injected external trigger source (0: software, see injected_start())
+	if(timer != 0) {
+		switch((uint32_t)(uintptr_t)timer->timer())
+		{
+			case TIM1_BASE: jextsel = 0; break;                                        // TIM1_TRGO
+			case TIM2_BASE: jextsel = ADC_CR2_JEXTSEL_1; break;                        // TIM2_TRGO
+			case TIM4_BASE: jextsel = (ADC_CR2_JEXTSEL_0 | ADC_CR2_JEXTSEL_2); break; // TIM4_TRGO
+			default: return 0;
+		}
+	}
+
+	// Injected sequence: JSQ(4 - count + 1) to JSQ4, results in JDR1 to JDR(count)
+	for(i = 0; i < count; i++) {
+		GPIO gpio(pins[i], Pin_AN);
+
+		channel = AnalogIn::channel(pins[i]);
+		if(channel == ADC_CHANNEL_NONE) return 0;
+
+		jsqr |= ((uint32_t)channel << ((ADC_INJECTED_MAX - count + i) * 5));
+	}
+
+	jsqr |= ((uint32_t)(count - 1) << ADC_JSQR_JL_Pos);
+
+	AnalogIn::stop();
+
+	// ADC configuration needed ?
+	if(ADC1->CR2 == 0) AnalogIn::adc();
+
+	for(i = 0; i < count; i++)
+		AnalogIn::sampling(ADC1, AnalogIn::channel(pins[i]), time);
+
+	ADC1->JSQR = jsqr;
+
+	m_injectedCount = count;
+	m_injectedCallback = f;
+
+	// ADC start: timer event
+	ADC1->CR2 &= ~ADC_CR2_JEXTSEL;
+	ADC1->CR2 |= (ADC_CR2_JEXTTRIG | jextsel);
+
+	// End of injected conversion interrupt
+	ADC1->SR = ~ADC_SR_JEOC; // rc_w0
+	ADC1->CR1 |= ADC_CR1_JEOCIE;
+
+	AnalogIn::start();
+
+	// Trigger output: timer update (PWM period unchanged)
+	if(timer != 0) timer->trigger();
+
+	return 1;
+}
+
+void AnalogIn :: injected_start(void)
+{
+	// Software trigger
+	ADC1->CR2 |= ADC_CR2_JSWSTART;
+}
+
+void AnalogIn :: injected_stop(void)
+{
+	// Disable end of injected conversion interrupt
+	ADC1->CR1 &= ~ADC_CR1_JEOCIE;
+
+	// ADC start: software event
+	ADC1->CR2 |= (ADC_CR2_JEXTSEL_0 | ADC_CR2_JEXTSEL_1 | ADC_CR2_JEXTSEL_2);
+
+	m_injectedCallback = 0;
+}
+
+void AnalogIn :: irq(void)
+{
+	// End of injected sequence ?
+	if((ADC1->SR & ADC_SR_JEOC) != 0) {
+		ADC1->SR = ~ADC_SR_JEOC; // rc_w0
+
+		// Results: JDR1 to JDR4 (fall through)
+		switch(m_injectedCount)
+		{
+			case 4: m_injected[3] = (uint16_t)ADC1->JDR4;
+			case 3: m_injected[2] = (uint16_t)ADC1->JDR3;
+			case 2: m_injected[1] = (uint16_t)ADC1->JDR2;
+			case 1: m_injected[0] = (uint16_t)ADC1->JDR1;
+			default: break;
+		}
+
+		// Callback ?
+		if(m_injectedCallback != 0)
+			(*m_injectedCallback)(m_injected, m_injectedCount);
+	}
+
+	// Analog watchdog (one shot) ?
+	if(((ADC1->SR & ADC_SR_AWD) != 0) && ((ADC1->CR1 & ADC_CR1_AWDIE) != 0)) {
+		ADC1->SR = ~ADC_SR_AWD; // rc_w0
+		ADC1->CR1 &= ~ADC_CR1_AWDIE;
+
+		// Callback ?
+		if(m_watchdogCallback != 0)
+			(*m_watchdogCallback)();
+	}
+}
+
+void AnalogIn :: watchdog(uint16_t low, uint16_t high, void(*f)(void))
+{
+	if(m_channel == ADC_CHANNEL_NONE) return;
+
+	AnalogIn::watchdog_all(low, high, f);
+
+	// Single channel
+	ADC1->CR1 &= ~ADC_CR1_AWDCH;
+	ADC1->CR1 |= (ADC_CR1_AWDSGL | ((uint32_t)m_channel << ADC_CR1_AWDCH_Pos));
+}
+
+void AnalogIn :: watchdog_all(uint16_t low, uint16_t high, void(*f)(void))
+{
+	// Window thresholds
+	ADC1->LTR = (low & 0x0FFF);
+	ADC1->HTR = (high & 0x0FFF);
+
+	m_watchdogCallback = f;
+
+	// All regular channels
+	ADC1->CR1 &= ~(ADC_CR1_AWDSGL | ADC_CR1_AWDCH);
+
+	// Analog watchdog on regular channels: enabled
+	ADC1->CR1 |= ADC_CR1_AWDEN;
+
+	AnalogIn::watchdog_arm();
+}
+
+void AnalogIn :: watchdog_arm(void)
+{
+	// Clear flag, enable interrupt
+	ADC1->SR = ~ADC_SR_AWD; // rc_w0
+	ADC1->CR1 |= ADC_CR1_AWDIE;
+}
+
+void AnalogIn :: watchdog_stop(void)
+{
+	ADC1->CR1 &= ~(ADC_CR1_AWDEN | ADC_CR1_AWDIE);
 
-	// Enable DMA clock
-	RCC->AHBENR |= RCC_AHBENR_DMA1EN;
+	m_watchdogCallback = 0;
+}
+
+uint8_t AnalogIn :: oversample(uint8_t ratio, AnalogFilter filter, uint8_t bits)
+{
+	uint8_t extra = 0;
+	uint8_t i = 0;
+	uint8_t c = 0;
+
+	// 12 to 16 bits, 4 x oversampling per extra bit
+	if((bits < 12) || (bits > 16) || (ratio == 0) || (ratio > ADC_OVERSAMPLING_MAX)) return 0;
+
+	extra = bits - 12;
+	if(ratio < (extra * 2)) return 0;
+
+	// Whole number of outputs per half buffer
+	if((m_block == 0) || ((m_blockScans & ((1 << ratio) - 1)) != 0)) return 0;
+
+	// Disable DMA interrupt processing while reconfiguring
+	m_ratio = 0;
+
+	// Gain: boxcar 2^ratio, CIC 2^(2 x ratio)
+	m_filter = filter;
+	m_shift = ((filter == Filter_Cic) ? (ratio * 2) : ratio) - extra;
+
+	for(i = 0; i < 4; i++) {
+		for(c = 0; c < (ADC_CHANNELS_MAX * 2); c++) m_cic[i][c] = 0;
+	}
+
+	m_ratio = ratio;
+
+	return 1;
+}
+
+void AnalogIn :: oversample_stop(void)
+{
+	m_ratio = 0;
+}
+
+void AnalogIn :: sequence(ADC_TypeDef* adc, uint8_t rank, uint8_t channel)
+{
+	// Regular sequence: SQR3 ranks 1-6, SQR2 ranks 7-12, SQR1 ranks 13-16
+	if(rank < 6) {
+		adc->SQR3 &= ~(ADC_SQR3_SQ1 << (rank * 5));
+		adc->SQR3 |= ((uint32_t)channel << (rank * 5));
+	} else if(rank < 12) {
+		adc->SQR2 &= ~(ADC_SQR2_SQ7 << ((rank - 6) * 5));
+		adc->SQR2 |= ((uint32_t)channel << ((rank - 6) * 5));
+	} else {
+		adc->SQR1 &= ~(ADC_SQR1_SQ13 << ((rank - 12) * 5));
+		adc->SQR1 |= ((uint32_t)channel << ((rank - 12) * 5));
+	}
+}
+
+void AnalogIn :: sampling(ADC_TypeDef* adc, uint8_t channel, AnalogSampleTime value)
+{
+	// SMPR1 channels 10-17, SMPR2 channels 0-9
+	if(channel >= 10) {
+		adc->SMPR1 &= ~(ADC_SMPR1_SMP10 << ((channel - 10) * 3));
+		adc->SMPR1 |= ((uint32_t)value << ((channel - 10) * 3));
+	} else {
+		adc->SMPR2 &= ~(ADC_SMPR2_SMP0 << (channel * 3));
+		adc->SMPR2 |= ((uint32_t)value << (channel * 3));
+	}
+}
+
+uint32_t AnalogIn :: clock(void)
+{
+	uint32_t tmp = 0;
 
-	// Clear DMA1 channel1 configuration register
-	DMA1_Channel1->CCR = 0;
+	// ADC clock: PCLK2 / ADCPRE (2, 4, 6 or 8)
+	tmp = APBPrescTable[(RCC->CFGR & RCC_CFGR_PPRE2) >> RCC_CFGR_PPRE2_Pos];
 
-	// Channel priority: high
-	DMA1_Channel1->CCR |= DMA_CCR_PL_1;
+	return ((SystemCoreClock >> tmp) / ((((RCC->CFGR & RCC_CFGR_ADCPRE) >> RCC_CFGR_ADCPRE_Pos) + 1) * 2));
+}
 
-	// Memory size: 16 bits
-	DMA1_Channel1->CCR |= DMA_CCR_MSIZE_0;
+void AnalogIn :: sample_time(AnalogSampleTime value)
+{
+	if(m_channel == ADC_CHANNEL_NONE) return;
 
-	// Peripheral size: 16 bits
-	DMA1_Channel1->CCR |= DMA_CCR_PSIZE_0;
+	m_sampleTime = value;
 
-	// Memory increment method: enabled
-	DMA1_Channel1->CCR |= DMA_CCR_MINC;
+	AnalogIn::sampling(ADC1, m_channel, value);
 
-	// Circular mode: enabled
-	DMA1_Channel1->CCR |= DMA_CCR_CIRC;
+	// Dual mode: same sampling time on both ADC
+	if(m_pair != ADC_CHANNEL_NONE)
+		AnalogIn::sampling(ADC2, m_pair, value);
+}
 
-	// Data transfer direction: peripheral to memory
+void AnalogIn :: impedance(uint32_t ohms)
+{
+	this->sample_time(AnalogIn::sample_time_min(ohms));
+}
+
+AnalogSampleTime AnalogIn :: sample_time_min(uint32_t ohms)
+{
+	// Sampling time in half cycles
+	static const uint16_t cycles[8] = {3, 15, 27, 57, 83, 111, 143, 479};
 
-	// Number of data to transfer
-	DMA1_Channel1->CNDTR = (uint32_t)m_ranks;
+	uint32_t clock = AnalogIn::clock() / 1000;
+	uint32_t max = 0;
+	uint8_t i = 0;
 
-	// Peripheral data register address
-	DMA1_Channel1->CPAR = (uint32_t)&ADC1->DR;
+	// RAIN max = TS / (fADC x CADC x ln(2^(N + 2))) - RADC (CADC = 8pF, RADC = 1k, N = 12)
+	for(i = 0; i < 7; i++) {
+		max = (cycles[i] * 6441000UL) / clock;
 
-	// Memory address to which the data will be written
-	DMA1_Channel1->CMAR = (uint32_t)&m_value[0];
+		if(max > (ohms + 1000)) break;
+	}
 
-	// Enable DMA1 channel1
-	DMA1_Channel1->CCR |= DMA_CCR_EN;
+	return (AnalogSampleTime)i;
+}
+
+void AnalogIn :: pair(PinName pin)
+{
+	GPIO gpio(pin, Pin_AN);
+
+	uint8_t channel = AnalogIn::channel(pin);
+
+	// ADC2: external channels only
+	if((m_channel == ADC_CHANNEL_NONE) || (channel == ADC_CHANNEL_NONE)) return;
+
+	AnalogIn::stop();
+
+	// ADC2 configuration needed ?
+	if(m_dual == 0) {
+		// Enable ADC2 clock
+		RCC->APB2ENR |= RCC_APB2ENR_ADC2EN;
+
+		// Clear configuration registers
+		ADC2->CR1 = 0;
+		ADC2->CR2 = 0;
+		ADC2->SQR1 = 0;
+		ADC2->SQR2 = 0;
+		ADC2->SQR3 = 0;
+
+		// Scan mode: enabled
+		ADC2->CR1 |= ADC_CR1_SCAN;
+
+		// Conversion mode: same as ADC1
+		ADC2->CR2 |= (ADC1->CR2 & ADC_CR2_CONT);
+
+		// ADC start: software event (triggered by ADC1 in dual mode)
+		ADC2->CR2 |= (ADC_CR2_EXTTRIG | ADC_CR2_EXTSEL_0 | ADC_CR2_EXTSEL_1 | ADC_CR2_EXTSEL_2);
+
+		// Same number of channels to convert
+		ADC2->SQR1 |= (ADC1->SQR1 & ADC_SQR1_L);
+
+		// Dual mode: regular simultaneous
+		ADC1->CR1 &= ~ADC_CR1_DUALMOD;
+		ADC1->CR1 |= (ADC_CR1_DUALMOD_1 | ADC_CR1_DUALMOD_2);
+
+		m_dual = 1;
+
+		// DMA reconfiguration (32 bits)
+		AnalogIn::dma();
+	}
+
+	m_pair = channel;
+
+	AnalogIn::sequence(ADC2, m_rank, m_pair);
+	AnalogIn::sampling(ADC2, m_pair, m_sampleTime);
+
+	AnalogIn::start();
+}
+
+uint16_t AnalogIn :: read_pair(void)
+{
+	if(m_pair == ADC_CHANNEL_NONE) return 0;
+
+	return m_value[(m_rank * 2) + 1];
+}
+
+uint32_t AnalogIn :: trigger(Timer* timer, uint32_t rate)
+{
+	uint32_t result = 0;
+	uint32_t extsel = 0;
+
+	// ADC1 regular external trigger source
+	switch((uint32_t)(uintptr_t)timer->timer())
+	{
+		case TIM1_BASE: extsel = 0; break;                                     // TIM1_CC1
+		case TIM2_BASE: extsel = (ADC_CR2_EXTSEL_0 | ADC_CR2_EXTSEL_1); break; // TIM2_CC2
+		case TIM3_BASE: extsel = ADC_CR2_EXTSEL_2; break;                      // TIM3_TRGO
+		case TIM4_BASE: extsel = (ADC_CR2_EXTSEL_0 | ADC_CR2_EXTSEL_2); break; // TIM4_CC4
+		default: return 0;
+	}
+
+	AnalogIn::stop();
+
+	// Conversion mode: single scan per trigger
+	ADC1->CR2 &= ~ADC_CR2_CONT;
+	if(m_dual != 0) ADC2->CR2 &= ~ADC_CR2_CONT;
+
+	// ADC start: timer event
+	ADC1->CR2 &= ~ADC_CR2_EXTSEL;
+	ADC1->CR2 |= (ADC_CR2_EXTTRIG | extsel);
+
+	// Restart DMA on rank 0
+	AnalogIn::dma();
+	AnalogIn::start();
+
+	// Timer configuration
+	switch((uint32_t)(uintptr_t)timer->timer())
+	{
+		case TIM1_BASE: result = timer->trigger(rate, Channel_1); break;
+		case TIM2_BASE: result = timer->trigger(rate, Channel_2); break;
+		case TIM3_BASE: result = timer->trigger(rate); break;
+		case TIM4_BASE: result = timer->trigger(rate, Channel_4); break;
+		default: break;
+	}
+
+	return result;
+}
+
+void AnalogIn :: trigger_stop(void)
+{
+	AnalogIn::stop();
+
+	// Conversion mode: continuous
+	ADC1->CR2 |= ADC_CR2_CONT;
+	if(m_dual != 0) ADC2->CR2 |= ADC_CR2_CONT;
+
+	// ADC start: software event
+	ADC1->CR2 |= (ADC_CR2_EXTTRIG | ADC_CR2_EXTSEL_0 | ADC_CR2_EXTSEL_1 | ADC_CR2_EXTSEL_2);
+
+	AnalogIn::dma();
+	AnalogIn::start();
 }
 
 uint8_t AnalogIn :: channel(PinName pin)
 {
 	uint32_t port = pin & 0xFFFFFF00;
 	uint8_t in = (uint8_t)pin;
-	uint8_t channel = 0;
+	uint8_t channel = ADC_CHANNEL_NONE;
 
+	// Analog pins: PA0-PA7, PB0-PB1, PC0-PC5
 	switch(port)
 	{
-		case GPIOA_BASE: channel = (in + ADC_CHANNEL_GPIOA_OFFSET) ; break;
-		case GPIOB_BASE: channel = (in + ADC_CHANNEL_GPIOB_OFFSET); break;
-		case GPIOC_BASE: channel = (in + ADC_CHANNEL_GPIOC_OFFSET); break;
+		case GPIOA_BASE: if(in <= 7) channel = (in + ADC_CHANNEL_GPIOA_OFFSET); break;
+		case GPIOB_BASE: if(in <= 1) channel = (in + ADC_CHANNEL_GPIOB_OFFSET); break;
+		case GPIOC_BASE: if(in <= 5) channel = (in + ADC_CHANNEL_GPIOC_OFFSET); break;
 		default: break;
 	}
 
@@ -181,21 +713,117 @@ uint8_t AnalogIn :: channel(PinName pin)
 
 uint16_t AnalogIn :: read(void)
 {
-	return m_value[m_rank];
+	if(m_channel == ADC_CHANNEL_NONE) return 0;
+
+	return m_value[m_rank << m_dual];
 }
 
 AnalogIn :: operator uint16_t()
 {
-	return m_value[m_rank];
+	return this->read();
 }
 
-//extern "C"
-//{	
-//	void ADC1_2_IRQHandler(void)
-//	{
-//		if((ADC1->SR & ADC_SR_EOC) != 0)
-//		{
-//			ADC1->SR &= ~ADC_SR_EOC;
-//		}
-//	}
-//}
+uint16_t AnalogIn :: read_mv(void)
+{
+	uint16_t vref = 0;
+
+	if(m_vrefRank != ADC_CHANNEL_NONE)
+		vref = m_value[m_vrefRank << m_dual];
+
+	return AnalogIn::millivolts(this->read(), vref);
+}
+
+int16_t AnalogIn :: read_temperature(void)
+{
+	int32_t mv = this->read_mv();
+
+	// T = (V25 - Vsense) / Avg_Slope + 25 (0.1 degC)
+	return (int16_t)((((int32_t)m_v25 - mv) * 10000) / ADC_TEMP_SLOPE_UV + 250);
+}
+
+uint16_t AnalogIn :: vdda(void)
+{
+	uint32_t vref = 0;
+
+	if(m_vrefRank == ADC_CHANNEL_NONE) return ADC_VDDA_MV;
+
+	vref = m_value[m_vrefRank << m_dual];
+	if(vref == 0) return ADC_VDDA_MV;
+
+	// VDDA = VREFINT x full scale / VREFINT sample
+	return (uint16_t)(((uint32_t)m_vrefint * ADC_FULL_SCALE) / vref);
+}
+
+uint16_t AnalogIn :: millivolts(uint16_t value, uint16_t vref)
+{
+	// No VREFINT sample: nominal supply
+	if(vref == 0)
+		return (uint16_t)(((uint32_t)value * ADC_VDDA_MV) / ADC_FULL_SCALE);
+
+	// mV = value x VDDA / full scale = value x VREFINT / VREFINT sample
+	return (uint16_t)(((uint32_t)value * m_vrefint) / vref);
+}
+
+void AnalogIn :: calibrate(uint16_t vrefint, uint16_t v25)
+{
+	if(vrefint != 0) m_vrefint = vrefint;
+	if(v25 != 0) m_v25 = v25;
+}
+
+uint8_t AnalogIn :: rank(void)
+{
+	return m_rank;
+}
+
+uint8_t AnalogIn :: ranks(void)
+{
+	return m_ranks;
+}
+
+/////////////////////
+
+AnalogOut :: AnalogOut(PinName pin, TIM_TypeDef* timer, TimerChannel channel) : PwmOut(pin, SystemCoreClock / ANALOGOUT_RANGE, timer, channel)
+{
+	// Timer configuration: full clock, 12 bits period (whatever the timer clock)
+	m_timer->PSC = 0;
+	m_timer->ARR = ANALOGOUT_RANGE - 1;
+
+	this->write(0);
+
+	// reload prescaler, period and duty cycle
+	m_timer->EGR |= TIM_EGR_UG;
+}
+
+void AnalogOut :: write(uint16_t value)
+{
+	// Overflow protection
+	if(value >= ANALOGOUT_RANGE) value = ANALOGOUT_RANGE - 1;
+
+	// 12 to 16 bits: compare value unchanged (period: 2^12)
+	this->write_u16(value << 4);
+}
+
+uint16_t AnalogOut :: read(void)
+{
+	return (m_duty >> 4);
+}
+
+AnalogOut& AnalogOut :: operator= (uint16_t value)
+{
+	this->write(value);
+
+	return *this;
+}
+
+AnalogOut :: operator uint16_t()
+{
+	return this->read();
+}
+
+extern "C"
+{
+	void ADC1_2_IRQHandler(void)
+	{
+		AnalogIn::irq();
+	}
+}
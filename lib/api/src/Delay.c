@@ -2,9 +2,18 @@
 
 void Delay(uint32_t value)
 {
-	uint32_t tickstart = 0;
+	uint64_t tickstart = 0;
 
-	tickstart = SysTick_Value();
+	tickstart = SysTick_Micros();
 
-	while((SysTick_Value() - tickstart) < value);
+	while((SysTick_Micros() - tickstart) < ((uint64_t)value * 1000));
+}
+
+void Delay_us(uint32_t value)
+{
+	uint64_t tickstart = 0;
+
+	tickstart = SysTick_Micros();
+
+	while((SysTick_Micros() - tickstart) < value);
 }
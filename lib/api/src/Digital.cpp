@@ -48,7 +48,7 @@ InterruptIn :: InterruptIn(PinName pin) : GPIO(pin, Pin_Input)
 	// Alternate Function I/O clock enable
 	RCC->APB2ENR |= RCC_APB2ENR_AFIOEN;
 
-	port  = (((((uint32_t)m_port) - APB2PERIPH_BASE) >> 10) - 2);
+	port  = (((((uint32_t)(uintptr_t)m_port) - APB2PERIPH_BASE) >> 10) - 2);
 	shift = (0x04 * (m_pin & 0x03));
 	index = m_pin >> 0x02;
 
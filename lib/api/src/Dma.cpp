@@ -0,0 +1,229 @@
+/*!
+ * \file Dma.cpp
+ * \brief DMA API.
+ * \author Remi.Debord
+ * \version 1.0
+ * \date 17 octobre 2026
+ *
+ * DMA library (DMA1 channel allocation and transfers).
+ *
+ */
+
+#include "Dma.h"
+
+extern "C"
+{
+	static Dma* dma[DMA_CHANNELS];
+}
+
+uint8_t Dma :: channel(DmaRequest request)
+{
+	// DMA1 channel (1 to 7)
+	return (uint8_t)(request & 0x0F);
+}
+
+uint8_t Dma :: open(DmaRequest request, DmaDirection direction, DmaSize size, DmaPriority priority)
+{
+	uint8_t index = Dma::channel(request) - 1;
+
+	IRQn_Type irq = DMA1_Channel1_IRQn;
+
+	if(index >= DMA_CHANNELS) return 0;
+
+	// Channel already used by another peripheral ?
+	if((dma[index] != 0) && (dma[index] != this)) return 0;
+
+	// Release previous channel
+	if((m_channel != 0) && (m_index != index)) this->close();
+
+	switch(index)
+	{
+		case 0: m_channel = DMA1_Channel1; irq = DMA1_Channel1_IRQn; break;
+		case 1: m_channel = DMA1_Channel2; irq = DMA1_Channel2_IRQn; break;
+		case 2: m_channel = DMA1_Channel3; irq = DMA1_Channel3_IRQn; break;
+		case 3: m_channel = DMA1_Channel4; irq = DMA1_Channel4_IRQn; break;
+		case 4: m_channel = DMA1_Channel5; irq = DMA1_Channel5_IRQn; break;
+		case 5: m_channel = DMA1_Channel6; irq = DMA1_Channel6_IRQn; break;
+		case 6: m_channel = DMA1_Channel7; irq = DMA1_Channel7_IRQn; break;
+		default: break;
+	}
+
+	m_index = index;
+	m_mode = Dma_Normal;
+
+	dma[index] = this;
+
+	// Enable DMA clock
+	RCC->AHBENR |= RCC_AHBENR_DMA1EN;
+
+	// Clear DMA channel configuration and flags
+	m_channel->CCR = 0;
+	DMA1->IFCR = (DMA_IFCR_CGIF1 << (m_index * 4));
+
+	// Channel priority
+	m_channel->CCR |= ((uint32_t)priority << DMA_CCR_PL_Pos);
+
+	// Memory and peripheral size
+	m_channel->CCR |= ((uint32_t)size << DMA_CCR_MSIZE_Pos);
+	m_channel->CCR |= ((uint32_t)size << DMA_CCR_PSIZE_Pos);
+
+	// Memory increment mode: enabled
+	m_channel->CCR |= DMA_CCR_MINC;
+
+	// Data transfer direction
+	if(direction == Dma_MemoryToPeripheral) m_channel->CCR |= DMA_CCR_DIR;
+
+	// NVIC configuration
+	NVIC_SetPriority(irq, 1); // High: 0, Low: 3
+	NVIC_EnableIRQ(irq);
+
+	return 1;
+}
+
+void Dma :: close(void)
+{
+	if(m_channel != 0) {
+		this->stop();
+
+		dma[m_index] = 0;
+		m_channel = 0;
+	}
+}
+
+uint8_t Dma :: opened(void)
+{
+	return (m_channel != 0);
+}
+
+void Dma :: attach(void(*f)(void*, uint8_t), void* context)
+{
+	m_context = context;
+	m_callback = f;
+}
+
+void Dma :: detach(void)
+{
+	m_callback = 0;
+}
+
+void Dma :: start(volatile void* peripheral, void* memory, uint16_t length, DmaMode mode)
+{
+	// Disable DMA channel
+	m_channel->CCR &= ~DMA_CCR_EN;
+
+	// Clear flags
+	DMA1->IFCR = (DMA_IFCR_CGIF1 << (m_index * 4));
+
+	m_mode = mode;
+
+	// Double buffer (emulation): circular over both buffers
+	if(mode == Dma_DoubleBuffer) length = length * 2;
+
+	// Number of data, peripheral and memory address
+	m_channel->CNDTR = length;
+	m_channel->CPAR = (uint32_t)(uintptr_t)peripheral;
+	m_channel->CMAR = (uint32_t)(uintptr_t)memory;
+
+	// Mode and interrupts
+	m_channel->CCR &= ~(DMA_CCR_CIRC | DMA_CCR_HTIE | DMA_CCR_TCIE | DMA_CCR_TEIE);
+
+	// Single transfer: interrupt disables the channel once done
+	if(mode == Dma_Normal) {
+		m_channel->CCR |= (DMA_CCR_TCIE | DMA_CCR_TEIE);
+	} else {
+		m_channel->CCR |= DMA_CCR_CIRC;
+
+		if(m_callback != 0) m_channel->CCR |= (DMA_CCR_HTIE | DMA_CCR_TCIE | DMA_CCR_TEIE);
+	}
+
+	// Enable DMA channel
+	m_channel->CCR |= DMA_CCR_EN;
+}
+
+void Dma :: stop(void)
+{
+	// Disable DMA channel
+	m_channel->CCR &= ~DMA_CCR_EN;
+
+	// Clear flags
+	DMA1->IFCR = (DMA_IFCR_CGIF1 << (m_index * 4));
+}
+
+uint16_t Dma :: remaining(void)
+{
+	return (uint16_t)m_channel->CNDTR;
+}
+
+uint8_t Dma :: busy(void)
+{
+	uint8_t result = 0;
+
+	// Channel enabled (single transfer: disabled by interrupt once done)
+	if((m_channel != 0) && ((m_channel->CCR & DMA_CCR_EN) != 0)) result = 1;
+
+	return result;
+}
+
+void Dma :: irq(void)
+{
+	uint8_t events = 0;
+
+	// Channel flags: GIF, TCIF, HTIF, TEIF
+	events = (uint8_t)((DMA1->ISR >> ((m_index * 4) + 1)) & 0x07);
+
+	// Clear flags
+	DMA1->IFCR = (DMA_IFCR_CGIF1 << (m_index * 4));
+
+	// Single transfer done
+	if((m_mode == Dma_Normal) && ((events & (Dma_Complete | Dma_Error)) != 0))
+		m_channel->CCR &= ~DMA_CCR_EN;
+
+	// Callback ?
+	if((m_callback != 0) && (events != 0))
+		(*m_callback)(m_context, events);
+}
+
+extern "C"
+{
+	void DMA1_Channel1_IRQHandler(void)
+	{
+		if(dma[0] != 0)
+			dma[0]->irq();
+	}
+
+	void DMA1_Channel2_IRQHandler(void)
+	{
+		if(dma[1] != 0)
+			dma[1]->irq();
+	}
+
+	void DMA1_Channel3_IRQHandler(void)
+	{
+		if(dma[2] != 0)
+			dma[2]->irq();
+	}
+
+	void DMA1_Channel4_IRQHandler(void)
+	{
+		if(dma[3] != 0)
+			dma[3]->irq();
+	}
+
+	void DMA1_Channel5_IRQHandler(void)
+	{
+		if(dma[4] != 0)
+			dma[4]->irq();
+	}
+
+	void DMA1_Channel6_IRQHandler(void)
+	{
+		if(dma[5] != 0)
+			dma[5]->irq();
+	}
+
+	void DMA1_Channel7_IRQHandler(void)
+	{
+		if(dma[6] != 0)
+			dma[6]->irq();
+	}
+}
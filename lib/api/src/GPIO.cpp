@@ -19,7 +19,7 @@ GPIO :: GPIO(PinName pin, PinMode m)
 
 	if(pin != NC) {
 		// GPIO clock enable
-		clock((uint32_t) m_port);
+		clock((uint32_t)(uintptr_t)m_port);
 
 		// Configure pin in output
 		this->mode(m);
@@ -56,10 +56,10 @@ void GPIO :: type(PinType t)
 {
 	if(m_pin < 8) {
 		m_port->CRL  &= ~(GPIO_CRL_CNF0_0 << (m_pin * 4));
-		m_port->CRL |= ((GPIO_CRL_CNF0_0 & (uint32_t)t) << (m_pin * 4));
+		m_port->CRL |= (((uint32_t)t << GPIO_CRL_CNF0_Pos) << (m_pin * 4));
 	} else {
 		m_port->CRH  &= ~(GPIO_CRH_CNF8_0 << ((m_pin - 8) * 4));
-		m_port->CRH |= ((GPIO_CRH_CNF8_0 & (uint32_t)t) << ((m_pin - 8) * 4));
+		m_port->CRH |= (((uint32_t)t << GPIO_CRH_CNF8_Pos) << ((m_pin - 8) * 4));
 	}
 }
 
@@ -73,7 +73,7 @@ void GPIO :: pull(PinPull p)
 
 uint32_t GPIO :: port(void)
 {
-	return (uint32_t)m_port;
+	return (uint32_t)(uintptr_t)m_port;
 }
 
 uint32_t GPIO :: mask(void)
@@ -13,13 +13,11 @@
 
 extern "C"
 {
-	static CircularBuffer* bufferRx[2];
-	static CircularBuffer* bufferTx[2];
+	static CircularBuffer<uint8_t, I2C_BUFFER_SIZE>* bufferRx[2];
+	static CircularBuffer<uint8_t, I2C_BUFFER_SIZE>* bufferTx[2];
 }
 
-I2C :: I2C(I2C_TypeDef* i2c, PinName sda, PinName scl): m_sda(sda, Pin_AF), m_scl(scl, Pin_AF),
-                                                        m_circularRx(&m_bufferRx[0], I2C_BUFFER_SIZE),
-                                                        m_circularTx(&m_bufferTx[0], I2C_BUFFER_SIZE)
+I2C :: I2C(I2C_TypeDef* i2c, PinName sda, PinName scl): m_sda(sda, Pin_AF), m_scl(scl, Pin_AF)
 {
 	uint32_t tmp = 0;
 	uint8_t index = 0;
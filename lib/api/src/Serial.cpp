@@ -13,23 +13,28 @@
 
 extern "C"
 {
-	static CircularBuffer* bufferRx[2];
-	static CircularBuffer* bufferTx[2];
+	static SerialBase* serial[2];
 }
 
-Serial :: Serial(USART_TypeDef* usart, PinName rx, PinName tx): m_rx(rx, Pin_InputFloating), m_tx(tx, Pin_AF),
-																m_circularRx(&m_bufferRx[0], USART_BUFFER_SIZE),
-																m_circularTx(&m_bufferTx[0], USART_BUFFER_SIZE)
+SerialBase :: SerialBase(USART_TypeDef* usart, PinName rx, PinName tx): m_rx(rx, Pin_InputFloating), m_tx(tx, Pin_AF),
+                                                                        m_rts(NC, Pin_Output), m_cts(NC, Pin_InputFloating),
+                                                                        m_de(NC, Pin_Output), m_ck(NC, Pin_AF),
+                                                                        m_dmaRx(), m_dmaTx()
 {
-	uint8_t index = 0;
-	uint8_t prescaler = 0;
+	m_usart = usart;
 
-	IRQn_Type irq = USART1_IRQn;
+	m_dmaRxPosition = 0;
+	m_idle = 0;
 
-	m_usart = usart;
+	m_txCallback = 0;
+	m_txWatermark = 0;
+
+	this->stats_reset();
+
+	m_halfDuplex = 0;
 
 	// Enable USART clock
-	switch((uint32_t)usart)
+	switch((uint32_t)(uintptr_t)usart)
 	{
 		case USART1_BASE: RCC->APB2ENR |= RCC_APB2ENR_USART1EN; break;
 		case USART2_BASE: RCC->APB1ENR |= RCC_APB1ENR_USART2EN; break;
@@ -37,24 +42,14 @@ Serial :: Serial(USART_TypeDef* usart, PinName rx, PinName tx): m_rx(rx, Pin_Inp
 	}
 
 	// Configure Tx pin
-	if(tx != NC) Serial::pin(&m_tx);
-
-	// Link circular buffer
-	if(usart == USART1) index = 0;
-	else if(usart == USART2) index = 1;
-
-	bufferRx[index] = &m_circularRx;
-	bufferTx[index] = &m_circularTx;
-
-	// USART clock: USART1 64MHz (APB2), USART2 32 MHz (APB1)
-	if(m_usart == USART2) prescaler = 2;
-	else prescaler = 1;
+	if(tx != NC) SerialBase::pin(&m_tx);
 
 	// USART configuration (9600 8 N 1)
-	m_usart->BRR = SystemCoreClock / (prescaler * USART_BAUDRATE_DEFAULT); // Baudrate = fck (48MHz) / USARTDIV
-	m_usart->CR1 &= ~USART_CR1_M;                                          // Databits: 8
-	m_usart->CR1 &= ~(USART_CR1_PCE | USART_CR1_PS);                       // Parity: None
-	m_usart->CR2 &= ~USART_CR2_STOP;                                       // Stopbits: 1
+	m_baudrate = USART_BAUDRATE_DEFAULT;
+	m_usart->BRR = this->divider(m_baudrate);        // Baudrate = PCLK / USARTDIV
+	m_usart->CR1 &= ~USART_CR1_M;                    // Databits: 8
+	m_usart->CR1 &= ~(USART_CR1_PCE | USART_CR1_PS); // Parity: None
+	m_usart->CR2 &= ~USART_CR2_STOP;                 // Stopbits: 1
 
 	// USART mode (Rx and/or Tx)
 	m_usart->CR1 &= ~(USART_CR1_RE | USART_CR1_TE);
@@ -65,49 +60,113 @@ Serial :: Serial(USART_TypeDef* usart, PinName rx, PinName tx): m_rx(rx, Pin_Inp
 	// Disable flow control
 	m_usart->CR3 &= ~(USART_CR3_RTSE | USART_CR3_CTSE);
 
-	// USART interrupt (Rx and/or Tx)
+	// USART interrupt (Rx and/or Tx): enabled once the handler is linked
 	m_usart->CR1 &= ~(USART_CR1_RXNEIE | USART_CR1_TXEIE);
 
-	if(rx != NC) m_usart->CR1 |= USART_CR1_RXNEIE;
-	//if(tx != NC) m_usart->CR1 |= USART_CR1_TXEIE;
+	// Enable USART
+	m_usart->CR1 |= USART_CR1_UE;
+}
+
+void SerialBase :: link(void)
+{
+	uint8_t index = 0;
+
+	IRQn_Type irq = USART1_IRQn;
+
+	// Link interrupt handler
+	if(m_usart == USART1) index = 0;
+	else if(m_usart == USART2) index = 1;
+
+	serial[index] = this;
+
+	// USART interrupt (Rx)
+	if((m_usart->CR1 & USART_CR1_RE) != 0) m_usart->CR1 |= USART_CR1_RXNEIE;
 
 	// NVIC configuration
-	if(usart == USART1) irq = USART1_IRQn;
-	else if(usart == USART2) irq = USART2_IRQn;
+	if(m_usart == USART1) irq = USART1_IRQn;
+	else if(m_usart == USART2) irq = USART2_IRQn;
 
 	NVIC_SetPriority(irq, 1); // High: 0, Low: 3
 	NVIC_EnableIRQ(irq);
-
-	// Enable USART
-	m_usart->CR1 |= USART_CR1_UE;
 }
 
-void Serial :: pin(GPIO* gpio)
+void SerialBase :: pin(GPIO* gpio)
 {
 	// Set pin in push-pull, pull-down
 	gpio->type(Push_Pull);
 	gpio->pull(Pull_Down);
 }
 
-void Serial :: baudrate(uint32_t value)
+uint32_t SerialBase :: clock(void)
+{
+	uint32_t tmp = 0;
+
+	// USART clock: USART1 PCLK2 (APB2), USART2 PCLK1 (APB1)
+	if(m_usart == USART1)
+		tmp = APBPrescTable[(RCC->CFGR & RCC_CFGR_PPRE2) >> RCC_CFGR_PPRE2_Pos];
+	else
+		tmp = APBPrescTable[(RCC->CFGR & RCC_CFGR_PPRE1) >> RCC_CFGR_PPRE1_Pos];
+
+	return (SystemCoreClock >> tmp);
+}
+
+uint16_t SerialBase :: divider(uint32_t value)
+{
+	uint32_t tmp = 0;
+
+	// BRR = USARTDIV x 16 = PCLK / baudrate (rounded)
+	tmp = (this->clock() + (value / 2)) / value;
+
+	// USARTDIV: 1 (min) to 4095.9375 (max)
+	if(tmp < 16) tmp = 16;
+	if(tmp > 0xFFFF) tmp = 0xFFFF;
+
+	return (uint16_t)tmp;
+}
+
+void SerialBase :: baudrate(uint32_t value)
 {
-	uint8_t prescaler = 0;
+	if(value == 0) return;
+
+	m_baudrate = value;
 
 	// Disable USART
 	m_usart->CR1 &= ~USART_CR1_UE;
 
-	// USART clock: USART1 64MHz (APB2), USART2 32 MHz (APB1)
-	if(m_usart == USART2) prescaler = 2;
-	else prescaler = 1;
-
-	// Baudrate = fck (64MHz) / USARTDIV
-	m_usart->BRR = SystemCoreClock / (prescaler * value);
+	// Baudrate = PCLK / USARTDIV
+	m_usart->BRR = this->divider(m_baudrate);
 
 	// Enable USART
 	m_usart->CR1 |= USART_CR1_UE;
 }
 
-void Serial :: format(uint8_t databits, SerialParity parity, uint8_t stopbits)
+uint32_t SerialBase :: baudrate_achieved(void)
+{
+	uint32_t brr = m_usart->BRR;
+
+	return ((this->clock() + (brr / 2)) / brr);
+}
+
+int32_t SerialBase :: baudrate_error(void)
+{
+	int64_t tmp = (int64_t)this->baudrate_achieved() - (int64_t)m_baudrate;
+
+	// Error (ppm)
+	return (int32_t)((tmp * 1000000) / (int64_t)m_baudrate);
+}
+
+void SerialBase :: clock_update(void)
+{
+	uint8_t i = 0;
+
+	// System clock changed (ex: SystemInit after stop mode): reprogram all ports
+	for(i = 0; i < 2; i++) {
+		if(serial[i] != 0)
+			serial[i]->baudrate(serial[i]->m_baudrate);
+	}
+}
+
+void SerialBase :: format(uint8_t databits, SerialParity parity, uint8_t stopbits)
 {
 	uint32_t tmp = 0;
 
@@ -152,78 +211,544 @@ void Serial :: format(uint8_t databits, SerialParity parity, uint8_t stopbits)
 	m_usart->CR1 |= USART_CR1_UE;
 }
 
-uint8_t Serial :: write(uint8_t* buffer, uint16_t length)
+void SerialBase :: dma_open(void)
 {
-	uint16_t i = 0;
-	uint8_t result = 0;
+	DmaRequest requestRx = Dma_USART1_RX;
+	DmaRequest requestTx = Dma_USART1_TX;
+
+	// DMA requests (USART1: Tx ch4, Rx ch5 / USART2: Rx ch6, Tx ch7)
+	if(m_usart == USART1) {
+		requestRx = Dma_USART1_RX;
+		requestTx = Dma_USART1_TX;
+	} else if(m_usart == USART2) {
+		requestRx = Dma_USART2_RX;
+		requestTx = Dma_USART2_TX;
+	} else {
+		return;
+	}
 
-	// Tx buffer available ?
-	if(m_circularTx.count() == 0) {
-		for(i = 0; i < length; i++)
-			m_circularTx.put(buffer[i]);
+	// Channel owned by another peripheral: interrupt mode kept
+	if((m_usart->CR1 & USART_CR1_RE) != 0)
+		m_dmaRx.open(requestRx, Dma_PeripheralToMemory, Dma_8bits, Dma_High);
 
-		// Enable Tx interrupt
-		m_usart->CR1 |= USART_CR1_TXEIE;
+	// Tx: data sent straight from caller buffer
+	if(((m_usart->CR1 & USART_CR1_TE) != 0) && m_dmaTx.open(requestTx, Dma_MemoryToPeripheral, Dma_8bits, Dma_Medium)) {
+		// Disable TXE interrupt
+		m_usart->CR1 &= ~USART_CR1_TXEIE;
+
+		// Transfer complete/error
+		m_dmaTx.attach(&SerialBase::dma_tx_event, this);
+
+		// USART DMA transmitter
+		m_usart->CR3 |= USART_CR3_DMAT;
+	}
+}
+
+void SerialBase :: dma_start(uint8_t* buffer, uint16_t size)
+{
+	// Rx: circular buffer filled by DMA, framed by idle line interrupt
+	m_dmaRxPosition = 0;
+	m_idle = 0;
+
+	// Half/full transfer interrupt (buffer wrap without idle line)
+	m_dmaRx.attach(&SerialBase::dma_rx_event, this);
+	m_dmaRx.start(&m_usart->DR, buffer, size, Dma_Circular);
+
+	// USART DMA receiver and idle line interrupt
+	m_usart->CR3 |= USART_CR3_DMAR;
+	m_usart->CR1 |= USART_CR1_IDLEIE;
 
-		result = 1;
+	// Error interrupts (overrun, framing, noise, parity)
+	m_usart->CR3 |= USART_CR3_EIE;
+	m_usart->CR1 |= USART_CR1_PEIE;
+}
+
+uint16_t SerialBase :: dma_write(uint8_t* buffer, uint16_t length)
+{
+	uint16_t result = 0;
+
+	// Previous transfer done ?
+	if((m_dmaTx.busy() == 0) && (length != 0)) {
+		m_dmaTx.start(&m_usart->DR, buffer, length, Dma_Normal);
+
+		result = length;
 	}
 
 	return result;
 }
 
-uint16_t Serial :: read(uint8_t* buffer)
+void SerialBase :: dma_rx_event(void* context, uint8_t events)
+{
+	SerialBase* serial = (SerialBase*)context;
+
+	// Rx: half/full transfer
+	if((events & (Dma_Half | Dma_Complete)) != 0)
+		serial->irq_dma();
+}
+
+void SerialBase :: dma_tx_event(void* context, uint8_t events)
+{
+	SerialBase* serial = (SerialBase*)context;
+
+	(void)events;
+
+	// Tx: transfer complete/error (channel disabled by DMA driver)
+	if(serial->m_txCallback != 0)
+		(*serial->m_txCallback)();
+}
+
+void SerialBase :: attach_tx(void(*f)(void), uint16_t watermark)
+{
+	// Called from interrupt when free space rises to watermark (DMA mode: transfer complete)
+	m_txWatermark = watermark;
+	m_txCallback = f;
+}
+
+void SerialBase :: detach_tx(void)
+{
+	m_txCallback = 0;
+}
+
+void SerialBase :: flow(PinName rts, PinName cts)
+{
+	// RTS (USART1: PA12, USART2: PA1): software, ready when low
+	if(rts != NC) {
+		m_rts = GPIO(rts, Pin_Output);
+		m_rts.type(Push_Pull);
+		m_rts.write(0);
+	}
+
+	// CTS (USART1: PA11, USART2: PA0): hardware
+	m_usart->CR3 &= ~USART_CR3_CTSE;
+
+	if(cts != NC) {
+		m_cts = GPIO(cts, Pin_InputFloating);
+		m_usart->CR3 |= USART_CR3_CTSE;
+	}
+}
+
+void SerialBase :: half_duplex(PinName de)
+{
+	// Disable USART
+	m_usart->CR1 &= ~USART_CR1_UE;
+
+	// Single wire: Tx pin only, no synchronous/LIN/smartcard/IrDA
+	m_usart->CR2 &= ~(USART_CR2_CLKEN | USART_CR2_LINEN);
+	m_usart->CR3 &= ~(USART_CR3_SCEN | USART_CR3_IREN);
+	m_usart->CR3 |= USART_CR3_HDSEL;
+
+	// Tx pin open-drain: line released while receiving (shared with bus or transceiver RO)
+	m_tx.type(Open_Drain);
+
+	if(de != NC) {
+		// RS-485 transceiver: driver disabled (receive)
+		m_de = GPIO(de, Pin_Output);
+		m_de.type(Push_Pull);
+		m_de.write(0);
+	}
+
+	m_halfDuplex = 1;
+
+	// Receiver enabled while the bus is released
+	m_usart->CR1 |= USART_CR1_RE;
+
+	if(m_dmaRx.opened() == 0) m_usart->CR1 |= USART_CR1_RXNEIE;
+
+	// Enable USART
+	m_usart->CR1 |= USART_CR1_UE;
+}
+
+void SerialBase :: synchronous(PinName ck, uint8_t cpol, uint8_t cpha)
+{
+	// Disable USART
+	m_usart->CR1 &= ~USART_CR1_UE;
+
+	// CK pin
+	m_ck = GPIO(ck, Pin_AF);
+	m_ck.type(Push_Pull);
+
+	// No half-duplex/LIN/smartcard/IrDA
+	m_usart->CR2 &= ~USART_CR2_LINEN;
+	m_usart->CR3 &= ~(USART_CR3_HDSEL | USART_CR3_SCEN | USART_CR3_IREN);
+
+	// Clock polarity/phase, clock pulse on last data bit
+	m_usart->CR2 &= ~(USART_CR2_CPOL | USART_CR2_CPHA);
+
+	if(cpol != 0) m_usart->CR2 |= USART_CR2_CPOL;
+	if(cpha != 0) m_usart->CR2 |= USART_CR2_CPHA;
+
+	m_usart->CR2 |= (USART_CR2_LBCL | USART_CR2_CLKEN);
+
+	// Enable USART
+	m_usart->CR1 |= USART_CR1_UE;
+}
+
+void SerialBase :: drive(void)
+{
+	// Half-duplex: take the bus
+	if(m_halfDuplex != 0) {
+		// No release until data is queued (previous frame may complete meanwhile)
+		m_usart->CR1 &= ~USART_CR1_TCIE;
+
+		// Receiver disabled while driving (no echo)
+		m_usart->CR1 &= ~USART_CR1_RE;
+
+		if(m_de.port() != (NC & 0xFFFFFF00)) m_de.write(1);
+
+		m_usart->SR &= ~USART_SR_TC;
+	}
+}
+
+void SerialBase :: turnaround_arm(void)
 {
+	// Half-duplex: bus released on transmission complete (data queued)
+	if(m_halfDuplex != 0) m_usart->CR1 |= USART_CR1_TCIE;
+}
+
+void SerialBase :: turnaround(void)
+{
+	// Transmission complete interrupt
+	m_usart->CR1 &= ~USART_CR1_TCIE;
+	m_usart->SR &= ~USART_SR_TC;
+
+	// Half-duplex: release the bus
+	if(m_de.port() != (NC & 0xFFFFFF00)) m_de.write(0);
+
+	m_usart->CR1 |= USART_CR1_RE;
+}
+
+SerialStats SerialBase :: stats(void)
+{
+	return m_stats;
+}
+
+void SerialBase :: stats_reset(void)
+{
+	m_stats.overrun = 0;
+	m_stats.framing = 0;
+	m_stats.noise = 0;
+	m_stats.parity = 0;
+	m_stats.dropped = 0;
+}
+
+/////////////////////
+
+template <uint16_t SIZE>
+Serial<SIZE> :: Serial(USART_TypeDef* usart, PinName rx, PinName tx) : SerialBase(usart, rx, tx)
+{
+	m_frameEnabled = 0;
+	m_frameDelimiter = 0;
+	m_frameLength = 0;
+	m_frameCallback = 0;
+
+	// Link interrupt handler (object fully constructed)
+	this->link();
+}
+
+template <uint16_t SIZE>
+void Serial<SIZE> :: dma(void)
+{
+	this->dma_open();
+
+	// Rx channel owned: buffer handed to DMA (interrupt mode kept otherwise)
+	if(m_dmaRx.opened()) {
+		// Disable RXNE interrupt before the Rx buffer is handed to DMA
+		m_usart->CR1 &= ~USART_CR1_RXNEIE;
+
+		m_circularRx.flush();
+		this->dma_start(m_circularRx.data(), SIZE);
+	}
+
+	// Tx channel owned: Tx buffer unused
+	if(m_dmaTx.opened()) m_circularTx.flush();
+}
+
+template <uint16_t SIZE>
+void Serial<SIZE> :: dma_rx(void)
+{
+	uint8_t* data = m_circularRx.data();
+	uint16_t position = 0;
 	uint16_t length = 0;
 	uint16_t i = 0;
 
-	// Rx operation ongoing ?
-	if((m_usart->SR & USART_SR_IDLE) != 0) {
-		length = m_circularRx.count();
+	// DMA write index
+	position = (SIZE - m_dmaRx.remaining()) & (SIZE - 1);
+
+	// Commit received data
+	if(position != m_dmaRxPosition) {
+		length = (position - m_dmaRxPosition) & (SIZE - 1);
+
+		// Unread data overwritten ?
+		if(length > m_circularRx.space())
+			m_stats.dropped += length - m_circularRx.space();
 
-		if(length != 0) {
+		m_circularRx.commit(length);
+		this->flow_rx();
+
+		// Look for frame delimiters in received data
+		if(m_frameEnabled != 0) {
 			for(i = 0; i < length; i++)
-				buffer[i] = m_circularRx.get();
+				this->frame_byte(data[(m_dmaRxPosition + i) & (SIZE - 1)]);
 		}
+
+		m_dmaRxPosition = position;
 	}
+}
 
-	return length;
+template <uint16_t SIZE>
+void Serial<SIZE> :: flow_rx(void)
+{
+	uint16_t count = 0;
+
+	// RTS enabled ?
+	if(m_rts.port() != (NC & 0xFFFFFF00)) {
+		count = m_circularRx.count();
+
+		// Hysteresis: not ready above 3/4, ready below 1/4
+		if(count >= (SIZE - (SIZE / 4))) m_rts.write(1);
+		else if(count <= (SIZE / 4)) m_rts.write(0);
+	}
 }
 
-extern "C"
+template <uint16_t SIZE>
+void Serial<SIZE> :: frame_byte(uint8_t c)
 {
-	void USART1_IRQHandler(void)
-	{
-		if((USART1->SR & USART_SR_TXE) != 0) {
-			// Data to send ?
-			if(bufferTx[0]->count() && (bufferTx[0] != 0)) {
-				USART1->DR = bufferTx[0]->get();
-			} else {
-				// Disable TXE interrupt
-				USART1->CR1 &= ~USART_CR1_TXEIE;
-			}
+	m_frameLength++;
+
+	// End of frame ?
+	if(c == m_frameDelimiter) {
+		// Frame queue full: merged with next frame
+		if(m_frames.put(m_frameLength) != 0) {
+			m_frameLength = 0;
+
+			// Callback ?
+			if(m_frameCallback != 0)
+				(*m_frameCallback)();
 		}
+	}
+}
+
+template <uint16_t SIZE>
+uint16_t Serial<SIZE> :: write(uint8_t* buffer, uint16_t length)
+{
+	uint16_t result = 0;
+
+	if(length == 0) return 0;
+
+	// DMA mode
+	if(m_dmaTx.opened()) {
+		// Previous transfer done ?
+		if(m_dmaTx.busy()) return 0;
+
+		// Take the bus (half-duplex) before the first byte
+		this->drive();
+
+		result = this->dma_write(buffer, length);
+
+		this->turnaround_arm();
+
+		return result;
+	}
+
+	// Half-duplex: no bus release while queuing
+	if(m_halfDuplex != 0) m_usart->CR1 &= ~USART_CR1_TCIE;
+
+	// Append as much as fits
+	result = m_circularTx.put(buffer, length);
+
+	// Take the bus (half-duplex), then send
+	this->drive();
+
+	// Enable Tx interrupt
+	if(result != 0)
+		m_usart->CR1 |= USART_CR1_TXEIE;
+
+	this->turnaround_arm();
+
+	return result;
+}
+
+template <uint16_t SIZE>
+uint16_t Serial<SIZE> :: writeable(void)
+{
+	uint16_t result = 0;
+
+	// DMA mode: whole caller buffer when idle
+	if(m_dmaTx.opened()) {
+		if(m_dmaTx.busy() == 0) result = 0xFFFF;
+	} else {
+		result = m_circularTx.space();
+	}
+
+	return result;
+}
+
+template <uint16_t SIZE>
+uint16_t Serial<SIZE> :: read(uint8_t* buffer)
+{
+	uint16_t length = 0;
+	uint8_t idle = 0;
+
+	// Rx operation ongoing ? (DMA mode: idle line flag cleared by interrupt)
+	if(m_dmaRx.opened()) {
+		idle = m_idle;
+		m_idle = 0;
+	} else {
+		idle = ((m_usart->SR & USART_SR_IDLE) != 0);
+	}
+
+	if(idle != 0) {
+		length = m_circularRx.get(buffer, SIZE);
+		this->flow_rx();
+	}
+
+	return length;
+}
+
+template <uint16_t SIZE>
+uint16_t Serial<SIZE> :: read_span(SerialSpan* span)
+{
+	// Received data, in place (up to 2 regions when the buffer wraps)
+	return m_circularRx.peek(span->data, span->length);
+}
+
+template <uint16_t SIZE>
+void Serial<SIZE> :: consume(uint16_t length)
+{
+	// Release data processed in place
+	m_circularRx.skip(length);
+	this->flow_rx();
+}
+
+template <uint16_t SIZE>
+void Serial<SIZE> :: frame(uint8_t delimiter, void(*f)(void))
+{
+	// !important: shall be called before data is received
+	m_frameDelimiter = delimiter;
+	m_frameCallback = f;
+	m_frameLength = 0;
+	m_frames.flush();
+
+	m_frameEnabled = 1;
+}
+
+template <uint16_t SIZE>
+uint16_t Serial<SIZE> :: frames(void)
+{
+	// Complete frames ready
+	return m_frames.count();
+}
+
+template <uint16_t SIZE>
+uint16_t Serial<SIZE> :: read_frame(uint8_t* buffer, uint16_t length)
+{
+	uint16_t* frame = 0;
+	uint16_t result = 0;
+
+	// Frame ready ?
+	if(m_frames.peek(&frame) != 0) {
+		if(length > *frame) length = *frame;
 
-		if((USART1->SR & USART_SR_RXNE) != 0) {
-			if(bufferRx[0] != 0)
-				bufferRx[0]->put(USART1->DR);
+		result = m_circularRx.get(buffer, length);
+
+		// Frame truncated to buffer length
+		m_circularRx.skip(*frame - result);
+		m_frames.skip(1);
+
+		this->flow_rx();
+	}
+
+	return result;
+}
+
+template <uint16_t SIZE>
+void Serial<SIZE> :: irq(void)
+{
+	uint32_t status = m_usart->SR;
+	uint8_t c = 0;
+
+	// Errors
+	if((status & (USART_SR_ORE | USART_SR_FE | USART_SR_NE | USART_SR_PE)) != 0) {
+		if((status & USART_SR_ORE) != 0) m_stats.overrun++;
+		if((status & USART_SR_FE) != 0) m_stats.framing++;
+		if((status & USART_SR_NE) != 0) m_stats.noise++;
+		if((status & USART_SR_PE) != 0) m_stats.parity++;
+	}
+
+	// Transmission complete (half-duplex: bus turnaround within a few bit times)
+	if(((status & USART_SR_TC) != 0) && ((m_usart->CR1 & USART_CR1_TCIE) != 0)) {
+		// Nothing left to send ?
+		if((m_circularTx.count() == 0) && ((m_dmaTx.opened() == 0) || (m_dmaTx.remaining() == 0)))
+			this->turnaround();
+	}
+
+	if((status & USART_SR_TXE) != 0) {
+		// Data to send ?
+		if(m_circularTx.count()) {
+			m_usart->DR = m_circularTx.get();
+
+			// Free space reached watermark ?
+			if((m_txCallback != 0) && (m_circularTx.space() == m_txWatermark))
+				(*m_txCallback)();
+		} else {
+			// Disable TXE interrupt
+			m_usart->CR1 &= ~USART_CR1_TXEIE;
 		}
 	}
 
-	void USART2_IRQHandler(void)
-	{
-		if((USART2->SR & USART_SR_TXE) != 0) {
-			// Data to send ?
-			if(bufferTx[1]->count() && (bufferTx[1] != 0)) {
-				USART2->DR = bufferTx[1]->get();
-			} else {
-				// Disable TXE interrupt
-				USART2->CR1 &= ~USART_CR1_TXEIE;
-			}
+	// DMA mode
+	if(m_dmaRx.opened()) {
+		if((status & (USART_SR_IDLE | USART_SR_ORE | USART_SR_FE | USART_SR_NE | USART_SR_PE)) != 0) {
+			// Clear idle/error flags (SR read followed by DR read)
+			(void)m_usart->DR;
 		}
 
-		if((USART2->SR & USART_SR_RXNE) != 0) {
-			if(bufferRx[1] != 0)
-				bufferRx[1]->put(USART2->DR);
+		if((status & USART_SR_IDLE) != 0) {
+			// End of frame
+			this->dma_rx();
+			m_idle = 1;
 		}
+	} else if((status & (USART_SR_RXNE | USART_SR_ORE)) != 0) {
+		// Clear error flags
+		c = m_usart->DR;
+
+		if(m_circularRx.put(c) == 0) {
+			m_stats.dropped++;
+		} else {
+			if(m_frameEnabled != 0) this->frame_byte(c);
+		}
+
+		this->flow_rx();
+	}
+}
+
+template <uint16_t SIZE>
+void Serial<SIZE> :: irq_dma(void)
+{
+	// Rx: half/full transfer (flags cleared by DMA driver)
+	this->dma_rx();
+}
+
+// Supported buffer sizes
+template class Serial<16>;
+template class Serial<32>;
+template class Serial<64>;
+template class Serial<128>;
+template class Serial<256>;
+template class Serial<512>;
+template class Serial<1024>;
+
+extern "C"
+{
+	void USART1_IRQHandler(void)
+	{
+		if(serial[0] != 0)
+			serial[0]->irq();
+	}
+
+	void USART2_IRQHandler(void)
+	{
+		if(serial[1] != 0)
+			serial[1]->irq();
 	}
 }
@@ -0,0 +1,170 @@
+/*!
+ * \file SoftTimer.cpp
+ * \brief Software timer API.
+ * \author Remi.Debord
+ * \version 1.0
+ * \date 17 octobre 2026
+ *
+ * Software timer library (hierarchical timing wheel).
+ *
+ */
+
+#include "SoftTimer.h"
+
+SoftTimer* SoftTimer::m_wheel[SOFTTIMER_LEVELS][SOFTTIMER_SLOTS];
+__IO uint32_t SoftTimer::m_now = 0;
+
+SoftTimer :: SoftTimer()
+{
+	m_next = 0;
+	m_pprev = 0;
+	m_expires = 0;
+	m_period = 0;
+	m_callback = 0;
+	m_context = 0;
+}
+
+void SoftTimer :: insert(SoftTimer* timer)
+{
+	uint32_t expires = timer->m_expires;
+	uint32_t delta = expires - m_now;
+	SoftTimer** head = 0;
+	uint8_t level = 0;
+
+	// Beyond the wheel span: parked on the last level, placed again when cascaded
+	if(delta >= (1UL << (SOFTTIMER_SLOT_BITS * SOFTTIMER_LEVELS))) {
+		delta = (1UL << (SOFTTIMER_SLOT_BITS * SOFTTIMER_LEVELS)) - 1;
+		expires = m_now + delta;
+	}
+
+	// Level: delta < 2^(6 x (level + 1)), slot from expiry tick bits of that level
+	while((level < (SOFTTIMER_LEVELS - 1)) && (delta >= (1UL << (SOFTTIMER_SLOT_BITS * (level + 1)))))
+		level++;
+
+	head = &m_wheel[level][(expires >> (SOFTTIMER_SLOT_BITS * level)) & SOFTTIMER_SLOT_MASK];
+
+	// Push front
+	timer->m_next = *head;
+	if(*head != 0) (*head)->m_pprev = &timer->m_next;
+	timer->m_pprev = head;
+	*head = timer;
+}
+
+void SoftTimer :: remove(SoftTimer* timer)
+{
+	// Unlink
+	*timer->m_pprev = timer->m_next;
+	if(timer->m_next != 0) timer->m_next->m_pprev = timer->m_pprev;
+
+	timer->m_next = 0;
+	timer->m_pprev = 0;
+}
+
+void SoftTimer :: cascade(uint8_t level, uint8_t slot)
+{
+	SoftTimer* timer = m_wheel[level][slot];
+	SoftTimer* next = 0;
+
+	m_wheel[level][slot] = 0;
+
+	// Move slot timers to lower levels
+	while(timer != 0) {
+		next = timer->m_next;
+		SoftTimer::insert(timer);
+		timer = next;
+	}
+}
+
+void SoftTimer :: once(void(*f)(void*), void* context, uint32_t ticks)
+{
+	uint32_t primask = __get_PRIMASK();
+
+	if(ticks == 0) ticks = 1;
+
+	__disable_irq();
+
+	if(m_pprev != 0) SoftTimer::remove(this);
+
+	m_callback = f;
+	m_context = context;
+	m_period = 0;
+	m_expires = m_now + ticks;
+
+	SoftTimer::insert(this);
+
+	__set_PRIMASK(primask);
+}
+
+void SoftTimer :: every(void(*f)(void*), void* context, uint32_t ticks)
+{
+	uint32_t primask = __get_PRIMASK();
+
+	if(ticks == 0) ticks = 1;
+
+	__disable_irq();
+
+	this->once(f, context, ticks);
+	m_period = ticks;
+
+	__set_PRIMASK(primask);
+}
+
+void SoftTimer :: cancel(void)
+{
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+
+	if(m_pprev != 0) SoftTimer::remove(this);
+
+	m_period = 0;
+
+	__set_PRIMASK(primask);
+}
+
+uint8_t SoftTimer :: active(void)
+{
+	return (m_pprev != 0);
+}
+
+void SoftTimer :: tick(void)
+{
+	SoftTimer** head = 0;
+	SoftTimer* timer = 0;
+	uint32_t now = m_now + 1;
+	uint8_t level = 0;
+	uint8_t slot = 0;
+
+	m_now = now;
+
+	// Lower level wrapped: cascade next level slot (level 1 to 3)
+	for(level = 1; level < SOFTTIMER_LEVELS; level++) {
+		if((now & ((1UL << (SOFTTIMER_SLOT_BITS * level)) - 1)) != 0) break;
+
+		slot = (now >> (SOFTTIMER_SLOT_BITS * level)) & SOFTTIMER_SLOT_MASK;
+		SoftTimer::cascade(level, slot);
+	}
+
+	// Expired timers (callback may start/cancel any timer)
+	head = &m_wheel[0][now & SOFTTIMER_SLOT_MASK];
+
+	while(*head != 0) {
+		timer = *head;
+		SoftTimer::remove(timer);
+
+		// Periodic: next expiry from previous one (no drift)
+		if(timer->m_period != 0) {
+			timer->m_expires += timer->m_period;
+			SoftTimer::insert(timer);
+		}
+
+		// Callback ?
+		if(timer->m_callback != 0)
+			(*timer->m_callback)(timer->m_context);
+	}
+}
+
+uint32_t SoftTimer :: now(void)
+{
+	return m_now;
+}
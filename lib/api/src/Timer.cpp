@@ -5,23 +5,28 @@
  * \version 1.0
  * \date 15 avril 2021
  *
- * Timer library (PWM, Ticker, TimeOut).
+ * Timer library (PWM, complementary PWM, Ticker, TimeOut, input capture, encoder).
  *
  */
 
 #include "Timer.h"
+#include "stm32f1xx_it.h"
 
 extern "C"
 {
 	void (*updateCallback[4])(void); // 4 timers
+	void (*compareCallback[4])(void); // 4 timers (CC3/CC4)
+	void (*breakCallback)(void);     // TIM1
 }
 
 Timer :: Timer(TIM_TypeDef* timer)
 {
 	m_timer = timer;
+	m_start = 0;
+	m_elapsed = 0;
 
 	// Enable timer clock
-	switch((uint32_t)timer)
+	switch((uint32_t)(uintptr_t)timer)
 	{
 		case TIM1_BASE : RCC->APB2ENR |= RCC_APB2ENR_TIM1EN; break;
 		case TIM2_BASE : RCC->APB1ENR |= RCC_APB1ENR_TIM2EN; break;
@@ -30,6 +35,9 @@ Timer :: Timer(TIM_TypeDef* timer)
 		default: break;
 	}
 
+	// Already running (ex: other PWM channel of the timer): configuration kept, no glitch
+	if((m_timer->CR1 & TIM_CR1_CEN) != 0) return;
+
 	// Center-aligned mode: edge aligned
 	m_timer->CR1 &= ~TIM_CR1_CMS;
 
@@ -54,32 +62,50 @@ Timer :: Timer(TIM_TypeDef* timer)
 
 void Timer :: start(void)
 {
+	// Already started: time kept
+	if((m_timer->CR1 & TIM_CR1_CEN) == 0) m_start = SysTick_Micros();
+
 	m_timer->CR1 |= TIM_CR1_CEN;
 }
 
 void Timer :: stop(void)
 {
+	if((m_timer->CR1 & TIM_CR1_CEN) != 0) m_elapsed += SysTick_Micros() - m_start;
+
 	m_timer->CR1 &= ~TIM_CR1_CEN;
 }
 
 void Timer :: reset(void)
 {
 	m_timer->CNT = 0;
+
+	m_start = SysTick_Micros();
+	m_elapsed = 0;
+}
+
+uint64_t Timer :: elapsed(void)
+{
+	uint64_t result = m_elapsed;
+
+	// Running: time since start() or reset()
+	if((m_timer->CR1 & TIM_CR1_CEN) != 0) result += SysTick_Micros() - m_start;
+
+	return result;
 }
 
 uint32_t Timer :: read(void)
 {
-	return (this->read_ms() / 1000);
+	return (uint32_t)(this->elapsed() / 1000000);
 }
 
 uint32_t Timer :: read_ms(void)
 {
-	return (this->read_us() / 1000);
+	return (uint32_t)(this->elapsed() / 1000);
 }
 
 uint32_t Timer :: read_us(void)
 {
-	return m_timer->CNT;
+	return (uint32_t)this->elapsed();
 }
 
 void Timer :: attach(void(*f)(void))
@@ -87,7 +113,7 @@ void Timer :: attach(void(*f)(void))
 	IRQn_Type irq = TIM1_UP_IRQn;
 	uint8_t i = 0;
 
-	switch((uint32_t)m_timer)
+	switch((uint32_t)(uintptr_t)m_timer)
 	{
 		case TIM1_BASE : i = 0; irq = TIM1_UP_IRQn; break;
 		case TIM2_BASE : i = 1; irq = TIM2_IRQn; break;
@@ -116,6 +142,119 @@ void Timer :: detach(void)
 	m_timer->SR &= ~TIM_SR_UIF;
 }
 
+uint32_t Timer :: clock(void)
+{
+	uint32_t tmp = 0;
+
+	// Timer clock: TIM1 PCLK2 (APB2), TIM2/3/4 PCLK1 (APB1)
+	if(m_timer == TIM1)
+		tmp = APBPrescTable[(RCC->CFGR & RCC_CFGR_PPRE2) >> RCC_CFGR_PPRE2_Pos];
+	else
+		tmp = APBPrescTable[(RCC->CFGR & RCC_CFGR_PPRE1) >> RCC_CFGR_PPRE1_Pos];
+
+	// APB prescaler > 1: timer clock = 2 x PCLK
+	if(tmp != 0) tmp--;
+
+	return (SystemCoreClock >> tmp);
+}
+
+void Timer :: trigger(void)
+{
+	// Master mode: update event as trigger output (TRGO)
+	m_timer->CR2 &= ~TIM_CR2_MMS;
+	m_timer->CR2 |= TIM_CR2_MMS_1;
+}
+
+uint32_t Timer :: setup(uint32_t frequency)
+{
+	uint32_t clock = this->clock();
+	uint32_t divider = 0;
+	uint32_t prescaler = 0;
+	uint32_t period = 0;
+
+	if(frequency == 0) return 0;
+
+	// Timer clock / frequency (rounded)
+	divider = (clock + (frequency / 2)) / frequency;
+	if(divider < 2) divider = 2;
+
+	// Smallest prescaler (best resolution), period <= 65535 (CCR > ARR possible: 100% PWM)
+	prescaler = (divider / 65535) + 1;
+	period = (divider + (prescaler / 2)) / prescaler;
+	if(period > 65535) period = 65535;
+
+	m_timer->PSC = prescaler - 1;
+	m_timer->ARR = period - 1;
+
+	return (clock / (prescaler * period));
+}
+
+uint32_t Timer :: trigger(uint32_t frequency)
+{
+	uint32_t result = 0;
+
+	if(frequency == 0) return 0;
+
+	// Disable timer
+	this->stop();
+
+	result = this->setup(frequency);
+
+	// reload prescaler and repetition counter
+	m_timer->EGR |= TIM_EGR_UG;
+
+	// Trigger output
+	this->trigger();
+
+	// Enable timer
+	this->reset();
+	this->start();
+
+	return result;
+}
+
+uint32_t Timer :: trigger(uint32_t frequency, TimerChannel channel)
+{
+	uint32_t result = 0;
+	uint32_t pulse = 0;
+
+	result = this->trigger(frequency);
+
+	if(result == 0) return 0;
+
+	// Channel configuration (compare event at half period)
+	if(channel > 2) {
+		// Capture compare mode: PWM1
+		m_timer->CCMR2 &= ~(TIM_CCMR2_OC3M << ((~channel & 0x01) * 8));
+		m_timer->CCMR2 |= (TIM_CCMR2_OC3M_1 | TIM_CCMR2_OC3M_2) << ((~channel & 0x01) * 8);
+	} else {
+		// Capture compare mode: PWM1
+		m_timer->CCMR1 &= ~(TIM_CCMR1_OC1M << ((~channel & 0x01) * 8));
+		m_timer->CCMR1 |= (TIM_CCMR1_OC1M_1 | TIM_CCMR1_OC1M_2) << ((~channel & 0x01) * 8);
+	}
+
+	pulse = (m_timer->ARR + 1) / 2;
+
+	switch(channel)
+	{
+		case Channel_1: m_timer->CCR1 = pulse; break;
+		case Channel_2: m_timer->CCR2 = pulse; break;
+		case Channel_3: m_timer->CCR3 = pulse; break;
+		case Channel_4: m_timer->CCR4 = pulse; break;
+		default: break;
+	}
+
+	// Output state: enabled (pin left untouched unless configured as alternate function)
+	m_timer->CCER |= TIM_CCER_CC1E << ((channel - 1) * 4);
+
+	return result;
+}
+
+TIM_TypeDef* Timer :: timer(void)
+{
+	return m_timer;
+}
+
 /////////////////////
 
 Ticker :: Ticker(TIM_TypeDef* timer) : Timer(timer)
@@ -222,42 +361,54 @@ void Timeout :: start(void)
 
 /////////////////////
 
-PwmOut :: PwmOut(PinName pin, uint32_t frequency, TIM_TypeDef* timer, TimerChannel channel) : GPIO(pin, Pin_AF), Timer(timer)
+PwmOut :: PwmOut(PinName pin, uint32_t frequency, TIM_TypeDef* timer, TimerChannel channel) : GPIO(pin, Pin_AF), Timer(timer), m_dma()
 {
-	uint32_t prescaler = 1;
-
 	m_timer = timer;
-	m_frequency = frequency;
-	m_dutyCycle = 0;
+	m_duty = 0;
 	m_channel = channel;
+	m_callback = 0;
+	m_buffer = 0;
+	m_length = 0;
+	m_mode = Dma_Normal;
+
+	switch(m_channel)
+	{
+		case Channel_1: m_ccr = &m_timer->CCR1; break;
+		case Channel_2: m_ccr = &m_timer->CCR2; break;
+		case Channel_3: m_ccr = &m_timer->CCR3; break;
+		default:        m_ccr = &m_timer->CCR4; break;
+	}
 
 	// GPIO configuration
 	this->type(Push_Pull);
 	this->pull(Pull_Up);
 
 	// Timer configuration
-	if((m_frequency < PWMOUT_LOW_FREQUENCY)) prescaler = (SystemCoreClock / 100000);
+	this->setup(frequency);
 
-	m_timer->PSC = prescaler - 1;
-	m_timer->ARR = ((SystemCoreClock / prescaler) / m_frequency) - 1;
+	// Auto-reload preload: new period applied on update
+	m_timer->CR1 |= TIM_CR1_ARPE;
 
 	// Channel configuration
 	if(m_channel > 2) {
-		// Capture compare mode: PWM1
-		m_timer->CCMR2 |= (TIM_CCMR2_OC3M_1 | TIM_CCMR2_OC3M_2) << ((~m_channel & 0x01) * 8);
+		// Capture compare mode: PWM1, preload (new duty cycle applied on update)
+		m_timer->CCMR2 |= (TIM_CCMR2_OC3M_1 | TIM_CCMR2_OC3M_2 | TIM_CCMR2_OC3PE) << ((~m_channel & 0x01) * 8);
 	} else {
-		// Capture compare mode: PWM1
-		m_timer->CCMR1 |= (TIM_CCMR1_OC1M_1 | TIM_CCMR1_OC1M_2) << ((~m_channel & 0x01) * 8);
+		// Capture compare mode: PWM1, preload (new duty cycle applied on update)
+		m_timer->CCMR1 |= (TIM_CCMR1_OC1M_1 | TIM_CCMR1_OC1M_2 | TIM_CCMR1_OC1PE) << ((~m_channel & 0x01) * 8);
 	}
 
-	// Output compare polarity: low
-	m_timer->CCER |= TIM_CCER_CC1P << ((m_channel - 1) * 4);
+	// Output compare polarity: high (active from period start)
+	m_timer->CCER &= ~(TIM_CCER_CC1P << ((m_channel - 1) * 4));
 
 	// Output state: enabled
 	m_timer->CCER |= TIM_CCER_CC1E << ((m_channel - 1) * 4);
 
 	// Set duty cycle
-	this->write(m_dutyCycle);
+	this->write_u16(m_duty);
+
+	// reload prescaler, period and duty cycle (timer already running: on next update, other channels untouched)
+	if((m_timer->CR1 & TIM_CR1_CEN) == 0) m_timer->EGR |= TIM_EGR_UG;
 
 	// Enable timer	
 	m_timer->CR1 |= TIM_CR1_CEN;
@@ -268,41 +419,65 @@ PwmOut :: PwmOut(PinName pin, uint32_t frequency, TIM_TypeDef* timer, TimerChann
 
 void PwmOut :: frequency(uint32_t value)
 {
-	uint32_t prescaler = 1;
+	uint32_t held = m_timer->CR1 & TIM_CR1_UDIS;
+	uint32_t previous = this->period();
+	uint32_t period = 0;
+	__IO uint32_t* ccr = 0;
+	uint8_t i = 0;
 
-	// Timer configuration
-	if((m_frequency < PWMOUT_LOW_FREQUENCY)) prescaler = (SystemCoreClock / 100000);
+	// New period and compare values switched on the same update event
+	this->hold();
 
-	m_timer->PSC = prescaler - 1;
-	m_timer->ARR = ((SystemCoreClock / prescaler) / m_frequency) - 1;
+	// Timer configuration (shared by all timer channels)
+	this->setup(value);
+	period = this->period();
 
-	// reload prescaler and repetition counter
-	m_timer->EGR |= TIM_EGR_UG;
+	// Enabled channels: same duty cycle with the new period (full scale kept)
+	for(i = 0; i < 4; i++) {
+		if((m_timer->CCER & (TIM_CCER_CC1E << (i * 4))) == 0) continue;
 
-	// !important
-	this->write(m_dutyCycle);
+		ccr = &m_timer->CCR1 + i;
+
+		if(*ccr >= previous) *ccr = period;
+		else *ccr = ((*ccr * period) + (previous / 2)) / previous;
+	}
+
+	// !important: exact value for this channel
+	this->write_u16(m_duty);
+
+	// Already held by the caller: applied on its release()
+	if(held == 0) this->release();
 }
 
-void PwmOut :: write(uint8_t value)
+uint32_t PwmOut :: frequency(void)
 {
-	uint32_t pulseWidth = 0;
+	// Timer registers: any channel may have changed the frequency
+	uint32_t ticks = (m_timer->PSC + 1) * (m_timer->ARR + 1);
+
+	// Center aligned: up/down counting, half the update rate
+	if((m_timer->CR1 & TIM_CR1_CMS) != 0) ticks = ticks * 2;
 
+	return (Timer::clock() / ticks);
+}
+
+void PwmOut :: write(uint8_t value)
+{
 	// Overflow protection
 	if(value >= PWMOUT_DUTYCYCLE_MAX) value = PWMOUT_DUTYCYCLE_MAX;
 
-	m_dutyCycle = value;
+	// Percent to 16 bits
+	this->write_u16((uint16_t)((value * 0xFFFFUL) / PWMOUT_DUTYCYCLE_MAX));
+}
+
+void PwmOut :: write_u16(uint16_t value)
+{
+	uint32_t period = this->period();
 
-	// Compute pulse width
-	pulseWidth = (100 - m_dutyCycle) * (m_timer->ARR - 1) / 100;
+	m_duty = value;
 
-	switch(m_channel)
-	{
-		case Channel_1: m_timer->CCR1 = pulseWidth; break;
-		case Channel_2: m_timer->CCR2 = pulseWidth; break;
-		case Channel_3: m_timer->CCR3 = pulseWidth; break;
-		case Channel_4: m_timer->CCR4 = pulseWidth; break;
-		default: break;
-	}
+	// Pulse width = duty x period / 2^16 (full scale: CCR > ARR, always active)
+	if(value == 0xFFFF) *m_ccr = period;
+	else *m_ccr = ((uint32_t)value * period) >> 16;
 }
 
 PwmOut& PwmOut :: operator= (uint8_t value)
@@ -314,7 +489,12 @@ PwmOut& PwmOut :: operator= (uint8_t value)
 
 uint8_t PwmOut :: read()
 {
-	return m_dutyCycle;
+	return (uint8_t)(((uint32_t)m_duty * PWMOUT_DUTYCYCLE_MAX + 0x7FFF) / 0xFFFF);
+}
+
+uint16_t PwmOut :: read_u16(void)
+{
+	return m_duty;
 }
 
 PwmOut :: operator uint8_t()
@@ -322,8 +502,546 @@ PwmOut :: operator uint8_t()
 	return this->read();
 }
 
+void PwmOut :: hold(void)
+{
+	// Update event disabled: preloaded CCR/ARR kept until release()
+	m_timer->CR1 |= TIM_CR1_UDIS;
+}
+
+void PwmOut :: release(void)
+{
+	// Every channel written since hold() switches on the same update event
+	m_timer->CR1 &= ~TIM_CR1_UDIS;
+}
+
+uint8_t PwmOut :: stream(uint16_t* buffer, uint16_t length, DmaMode mode, void(*f)(uint16_t*, uint16_t))
+{
+	DmaRequest request = Dma_TIM1_UP;
+
+	if((buffer == 0) || (length == 0)) return 0;
+
+	// Update DMA request
+	switch((uint32_t)(uintptr_t)m_timer)
+	{
+		case TIM1_BASE: request = Dma_TIM1_UP; break;
+		case TIM2_BASE: request = Dma_TIM2_UP; break;
+		case TIM3_BASE: request = Dma_TIM3_UP; break;
+		case TIM4_BASE: request = Dma_TIM4_UP; break;
+		default: return 0;
+	}
+
+	this->stream_stop();
+
+	if(m_dma.open(request, Dma_MemoryToPeripheral, Dma_16bits, Dma_VeryHigh) == 0) return 0;
+
+	m_buffer = buffer;
+	m_length = length;
+	m_mode = mode;
+	m_callback = f;
+
+	if(f != 0) m_dma.attach(&PwmOut::dma_event, this);
+	else m_dma.detach();
+
+	// One value per update event (compare preload: applied on the following period)
+	m_dma.start(m_ccr, buffer, length, mode);
+
+	// Update DMA request: enabled
+	m_timer->DIER |= TIM_DIER_UDE;
+
+	return 1;
+}
+
+void PwmOut :: stream_stop(void)
+{
+	if(m_dma.opened() == 0) return;
+
+	// Update DMA request: disabled
+	m_timer->DIER &= ~TIM_DIER_UDE;
+
+	m_dma.stop();
+	m_dma.close();
+
+	// Back to last written duty cycle
+	this->write_u16(m_duty);
+}
+
+uint8_t PwmOut :: streaming(void)
+{
+	return m_dma.busy();
+}
+
+uint32_t PwmOut :: period(void)
+{
+	// ARR + 1, shared by all timer channels
+	return (m_timer->ARR + 1);
+}
+
+void PwmOut :: dma_event(void* context, uint8_t events)
+{
+	PwmOut* out = (PwmOut*)context;
+
+	if(out->m_mode == Dma_DoubleBuffer) {
+		// First half played (second one being played)
+		if((events & Dma_Half) != 0)
+			(*out->m_callback)(&out->m_buffer[0], out->m_length);
+
+		// Second half played (first one being played)
+		if((events & Dma_Complete) != 0)
+			(*out->m_callback)(&out->m_buffer[out->m_length], out->m_length);
+	} else {
+		// Buffer played
+		if((events & Dma_Complete) != 0)
+			(*out->m_callback)(&out->m_buffer[0], out->m_length);
+	}
+}
+
+/////////////////////
+
+PwmComplementary :: PwmComplementary(PinName pin, PinName pinN, uint32_t frequency, TimerChannel channel, uint32_t deadtime, uint8_t center) : PwmOut(pin, (center != 0) ? (frequency * 2) : frequency, TIM1, channel),
+                                                                                                                                           m_outN(pinN, (channel == Channel_4) ? Pin_InputFloating : Pin_AF), m_break(NC, Pin_InputFloating)
+{
+	m_center = center;
+
+	// CH4: no complementary output, rejected (output disabled, pins floating)
+	if(m_channel == Channel_4) {
+		m_timer->CCER &= ~TIM_CCER_CC4E;
+		this->mode(Pin_InputFloating);
+		return;
+	}
+
+	// GPIO configuration
+	m_outN.type(Push_Pull);
+
+	// Off-state: outputs driven to idle level (low) when disabled or on break
+	m_timer->BDTR |= (TIM_BDTR_OSSR | TIM_BDTR_OSSI);
+
+	// Dead-time
+	this->deadtime(deadtime);
+
+	// Center-aligned mode 1 (up/down counting, half the update rate, period set by PwmOut),
+	// written with the counter stopped: first channel only, channels already running untouched
+	if((m_center != 0) && ((m_timer->CR1 & TIM_CR1_CMS) == 0)) {
+		m_timer->CR1 &= ~TIM_CR1_CEN;
+
+		m_timer->CR1 &= ~TIM_CR1_CMS;
+		m_timer->CR1 |= TIM_CR1_CMS_0;
+
+		// reload prescaler and period
+		m_timer->EGR |= TIM_EGR_UG;
+
+		m_timer->CR1 |= TIM_CR1_CEN;
+	}
+
+	// Complementary output state: enabled (polarity: high)
+	m_timer->CCER &= ~(TIM_CCER_CC1NP << ((m_channel - 1) * 4));
+	m_timer->CCER |= TIM_CCER_CC1NE << ((m_channel - 1) * 4);
+}
+
+void PwmComplementary :: frequency(uint32_t value)
+{
+	// Center aligned: counter period = 2 x ARR
+	if(m_center != 0) {
+		PwmOut::frequency(value * 2);
+	} else {
+		PwmOut::frequency(value);
+	}
+}
+
+uint32_t PwmComplementary :: frequency(void)
+{
+	return PwmOut::frequency();
+}
+
+uint8_t PwmComplementary :: dtg(uint32_t clock, uint32_t ns)
+{
+	uint32_t ticks = 0;
+
+	// Dead-time ticks (tDTS = 1 / timer clock, CKD = 0), rounded up
+	ticks = ((ns * (clock / 1000000)) + 999) / 1000;
+
+	// DTG[7:0]: 0xx: DTG x tDTS, 10x: (64 + DTG[5:0]) x 2 x tDTS
+	//           110: (32 + DTG[4:0]) x 8 x tDTS, 111: (32 + DTG[4:0]) x 16 x tDTS
+	if(ticks <= 127) return (uint8_t)ticks;
+	if(ticks <= (127 * 2)) return (uint8_t)(0x80 | (((ticks + 1) / 2) - 64));
+	if(ticks <= (63 * 8)) return (uint8_t)(0xC0 | (((ticks + 7) / 8) - 32));
+	if(ticks <= (63 * 16)) return (uint8_t)(0xE0 | (((ticks + 15) / 16) - 32));
+
+	return 0xFF;
+}
+
+uint32_t PwmComplementary :: deadtime(uint32_t ns)
+{
+	uint32_t clock = Timer::clock();
+	uint32_t ticks = 0;
+	uint8_t value = PwmComplementary::dtg(clock, ns);
+
+	m_timer->BDTR &= ~TIM_BDTR_DTG;
+	m_timer->BDTR |= ((uint32_t)value << TIM_BDTR_DTG_Pos);
+
+	// Applied dead-time
+	switch(value & 0xE0)
+	{
+		case 0xE0: ticks = (32 + (value & 0x1F)) * 16; break;
+		case 0xC0: ticks = (32 + (value & 0x1F)) * 8; break;
+		case 0x80:
+		case 0xA0: ticks = (64 + (value & 0x3F)) * 2; break;
+		default:   ticks = value; break;
+	}
+
+	return ((ticks * 1000) / (clock / 1000000));
+}
+
+void PwmComplementary :: fault(PinName pin, uint8_t level, void(*f)(void))
+{
+	m_break = GPIO(pin, Pin_InputFloating);
+
+	breakCallback = f;
+
+	// Break polarity
+	if(level != 0) m_timer->BDTR |= TIM_BDTR_BKP;
+	else m_timer->BDTR &= ~TIM_BDTR_BKP;
+
+	// Break input: enabled (main output cleared asynchronously)
+	m_timer->BDTR |= TIM_BDTR_BKE;
+
+	// Break interrupt
+	m_timer->SR = ~TIM_SR_BIF; // rc_w0
+
+	if(f != 0) {
+		m_timer->DIER |= TIM_DIER_BIE;
+
+		// NVIC configuration
+		NVIC_SetPriority(TIM1_BRK_IRQn, 0); // High: 0, Low: 3
+		NVIC_EnableIRQ(TIM1_BRK_IRQn);
+	} else {
+		m_timer->DIER &= ~TIM_DIER_BIE;
+	}
+}
+
+uint8_t PwmComplementary :: faulted(void)
+{
+	return ((m_timer->BDTR & TIM_BDTR_MOE) == 0);
+}
+
+void PwmComplementary :: resume(void)
+{
+	// Break still active: MOE cannot be set
+	m_timer->SR = ~TIM_SR_BIF; // rc_w0
+
+	// Break interrupt re-armed (disabled by the interrupt handler)
+	if(breakCallback != 0) m_timer->DIER |= TIM_DIER_BIE;
+
+	m_timer->BDTR |= TIM_BDTR_MOE;
+}
+
+/////////////////////
+
+InputCapture :: InputCapture(PinName pin, TIM_TypeDef* timer, uint32_t clock) : GPIO(pin, Pin_InputFloating), Timer(timer), m_dma()
+{
+	uint32_t prescaler = 1;
+
+	m_callback = 0;
+	m_buffer = 0;
+	m_captures = 0;
+
+	// Timer configuration: count at clock (rounded)
+	if(clock != 0) prescaler = (Timer::clock() + (clock / 2)) / clock;
+	if(prescaler == 0) prescaler = 1;
+	if(prescaler > 0x10000) prescaler = 0x10000;
+
+	m_clock = Timer::clock() / prescaler;
+
+	m_timer->PSC = prescaler - 1;
+	m_timer->ARR = 0xFFFF;
+
+	// IC1: TI1 rising edge (period), IC2: TI1 falling edge (high time)
+	m_timer->CCER &= ~(TIM_CCER_CC1E | TIM_CCER_CC2E | TIM_CCER_CC1P | TIM_CCER_CC2P);
+	m_timer->CCMR1 &= ~(TIM_CCMR1_CC1S | TIM_CCMR1_CC2S);
+	m_timer->CCMR1 |= (TIM_CCMR1_CC1S_0 | TIM_CCMR1_CC2S_1);
+	m_timer->CCER |= TIM_CCER_CC2P;
+
+	// Slave mode: reset on TI1FP1
+	m_timer->SMCR &= ~(TIM_SMCR_TS | TIM_SMCR_SMS);
+	m_timer->SMCR |= (TIM_SMCR_TS_0 | TIM_SMCR_TS_2 | TIM_SMCR_SMS_2);
+
+	// Update only on counter overflow (no edge within 65536 ticks)
+	m_timer->CR1 |= TIM_CR1_URS;
+
+	// Capture enabled
+	m_timer->CCER |= (TIM_CCER_CC1E | TIM_CCER_CC2E);
+
+	// reload prescaler and repetition counter
+	m_timer->EGR |= TIM_EGR_UG;
+
+	// Enable timer
+	m_timer->CR1 |= TIM_CR1_CEN;
+}
+
+void InputCapture :: filter(uint8_t value)
+{
+	// Same filter on IC1 and IC2 (both from TI1)
+	m_timer->CCMR1 &= ~(TIM_CCMR1_IC1F | TIM_CCMR1_IC2F);
+	m_timer->CCMR1 |= (((uint32_t)value & 0x0F) << TIM_CCMR1_IC1F_Pos) | (((uint32_t)value & 0x0F) << TIM_CCMR1_IC2F_Pos);
+}
+
+uint16_t InputCapture :: period(void)
+{
+	// Counter value on rising edge (reset right after)
+	return (uint16_t)m_timer->CCR1;
+}
+
+uint16_t InputCapture :: width(void)
+{
+	return (uint16_t)m_timer->CCR2;
+}
+
+uint32_t InputCapture :: frequency(void)
+{
+	uint16_t period = this->period();
+
+	if(period == 0) return 0;
+
+	return (m_clock / period);
+}
+
+uint16_t InputCapture :: duty(void)
+{
+	uint32_t period = this->period();
+	uint32_t width = this->width();
+
+	if(period == 0) return 0;
+	if(width >= period) return 0xFFFF;
+
+	return (uint16_t)((width * 0xFFFF) / period);
+}
+
+uint8_t InputCapture :: capture(uint16_t* buffer, uint16_t captures, void(*f)(uint16_t*, uint16_t))
+{
+	DmaRequest request = Dma_TIM1_CH1;
+
+	if((buffer == 0) || (captures == 0) || (captures > 0x3FFF)) return 0;
+
+	// Capture 1 DMA request
+	switch((uint32_t)(uintptr_t)m_timer)
+	{
+		case TIM1_BASE: request = Dma_TIM1_CH1; break;
+		case TIM2_BASE: request = Dma_TIM2_CH1; break;
+		case TIM3_BASE: request = Dma_TIM3_CH1; break;
+		case TIM4_BASE: request = Dma_TIM4_CH1; break;
+		default: return 0;
+	}
+
+	this->capture_stop();
+
+	if(m_dma.open(request, Dma_PeripheralToMemory, Dma_16bits, Dma_High) == 0) return 0;
+
+	m_buffer = buffer;
+	m_captures = captures;
+	m_callback = f;
+
+	if(f != 0) m_dma.attach(&InputCapture::dma_event, this);
+	else m_dma.detach();
+
+	// DMA burst: CCR1, CCR2 (base address offset in words from CR1)
+	m_timer->DCR = ((((uint32_t)(uintptr_t)&m_timer->CCR1 - (uint32_t)(uintptr_t)&m_timer->CR1) / 4) << TIM_DCR_DBA_Pos) | (1 << TIM_DCR_DBL_Pos);
+
+	m_dma.start(&m_timer->DMAR, buffer, captures * 2, Dma_DoubleBuffer);
+
+	// Capture 1 DMA request: enabled
+	m_timer->DIER |= TIM_DIER_CC1DE;
+
+	return 1;
+}
+
+void InputCapture :: capture_stop(void)
+{
+	// Capture 1 DMA request: disabled
+	m_timer->DIER &= ~TIM_DIER_CC1DE;
+
+	if(m_dma.opened() == 0) return;
+
+	// Channel released (shared with other requests)
+	m_dma.stop();
+	m_dma.close();
+}
+
+void InputCapture :: dma_event(void* context, uint8_t events)
+{
+	InputCapture* capture = (InputCapture*)context;
+
+	// First half full (second one being filled)
+	if((events & Dma_Half) != 0)
+		(*capture->m_callback)(&capture->m_buffer[0], capture->m_captures);
+
+	// Second half full (first one being filled)
+	if((events & Dma_Complete) != 0)
+		(*capture->m_callback)(&capture->m_buffer[capture->m_captures * 2], capture->m_captures);
+}
+
+/////////////////////
+
+QEI* QEI::m_qei[4];
+
+QEI :: QEI(PinName a, PinName b, TIM_TypeDef* timer) : Timer(timer), m_a(a, Pin_Input), m_b(b, Pin_Input)
+{
+	uint8_t i = 0;
+
+	m_count = 0;
+	m_last = 0;
+	m_sample = 0;
+	m_sampleTime = 0;
+	m_velocity = 0;
+
+	// GPIO configuration (open collector encoders)
+	m_a.pull(Pull_Up);
+	m_b.pull(Pull_Up);
+
+	// Timer configuration: every edge counted
+	m_timer->PSC = 0;
+	m_timer->ARR = 0xFFFF;
+
+	// IC1: TI1, IC2: TI2, rising polarity (not inverted)
+	m_timer->CCER &= ~(TIM_CCER_CC1P | TIM_CCER_CC2P);
+	m_timer->CCMR1 &= ~(TIM_CCMR1_CC1S | TIM_CCMR1_CC2S);
+	m_timer->CCMR1 |= (TIM_CCMR1_CC1S_0 | TIM_CCMR1_CC2S_0);
+
+	// Slave mode: encoder mode 3 (TI1 and TI2 edges)
+	m_timer->SMCR &= ~TIM_SMCR_SMS;
+	m_timer->SMCR |= (TIM_SMCR_SMS_0 | TIM_SMCR_SMS_1);
+
+	// Update only on counter overflow/underflow
+	m_timer->CR1 |= TIM_CR1_URS;
+
+	// CC3/CC4: output compare frozen (no pin), counter sampled at 1/3 and 2/3 of the range
+	m_timer->CCER &= ~(TIM_CCER_CC3E | TIM_CCER_CC4E);
+	m_timer->CCMR2 &= ~(TIM_CCMR2_CC3S | TIM_CCMR2_OC3M | TIM_CCMR2_CC4S | TIM_CCMR2_OC4M);
+	m_timer->CCR3 = 0x5555;
+	m_timer->CCR4 = 0xAAAA;
+
+	// reload prescaler and repetition counter
+	m_timer->EGR |= TIM_EGR_UG;
+	m_timer->CNT = 0;
+
+	// Counter extension
+	switch((uint32_t)(uintptr_t)m_timer)
+	{
+		case TIM1_BASE: i = 0; this->attach(&QEI::update<0>); compareCallback[0] = &QEI::update<0>; break;
+		case TIM2_BASE: i = 1; this->attach(&QEI::update<1>); compareCallback[1] = &QEI::update<1>; break;
+		case TIM3_BASE: i = 2; this->attach(&QEI::update<2>); compareCallback[2] = &QEI::update<2>; break;
+		case TIM4_BASE: i = 3; this->attach(&QEI::update<3>); compareCallback[3] = &QEI::update<3>; break;
+		default: break;
+	}
+
+	m_qei[i] = this;
+
+	// TIM1: capture compare interrupt apart (TIM2 to 4: shared with update)
+	if(i == 0) {
+		NVIC_SetPriority(TIM1_CC_IRQn, 1);
+		NVIC_EnableIRQ(TIM1_CC_IRQn);
+	}
+
+	m_timer->SR = ~(TIM_SR_CC3IF | TIM_SR_CC4IF); // rc_w0
+	m_timer->DIER |= (TIM_DIER_CC3IE | TIM_DIER_CC4IE);
+
+	// Enable timer
+	m_timer->CR1 |= TIM_CR1_CEN;
+}
+
+template <uint8_t N>
+void QEI :: update(void)
+{
+	QEI* qei = m_qei[N];
+
+	if(qei == 0) return;
+
+	qei->extend();
+}
+
+void QEI :: extend(void)
+{
+	uint16_t count = (uint16_t)m_timer->CNT;
+
+	// Less than half the range since last sample: signed difference, whatever the wraps and direction changes
+	m_count += (int16_t)(count - m_last);
+	m_last = count;
+}
+
+void QEI :: filter(uint8_t value)
+{
+	m_timer->CCMR1 &= ~(TIM_CCMR1_IC1F | TIM_CCMR1_IC2F);
+	m_timer->CCMR1 |= (((uint32_t)value & 0x0F) << TIM_CCMR1_IC1F_Pos) | (((uint32_t)value & 0x0F) << TIM_CCMR1_IC2F_Pos);
+}
+
+void QEI :: reset(void)
+{
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+
+	m_timer->CNT = 0;
+	m_timer->SR = ~(TIM_SR_UIF | TIM_SR_CC3IF | TIM_SR_CC4IF); // rc_w0
+	m_count = 0;
+	m_last = 0;
+
+	m_sample = 0;
+	m_velocity = 0;
+
+	__set_PRIMASK(primask);
+}
+
+int32_t QEI :: read(void)
+{
+	return (int32_t)this->read64();
+}
+
+int64_t QEI :: read64(void)
+{
+	uint32_t primask = __get_PRIMASK();
+	int64_t count = 0;
+
+	// Sample shared with the interrupt (pending or masked sample: same difference)
+	__disable_irq();
+
+	this->extend();
+	count = m_count;
+
+	__set_PRIMASK(primask);
+
+	return count;
+}
+
+void QEI :: sample(void)
+{
+	int64_t count = this->read64();
+	uint64_t time = SysTick_Micros();
+
+	if((m_sampleTime != 0) && (time != m_sampleTime))
+		m_velocity = (int32_t)(((count - m_sample) * 1000000) / (int64_t)(time - m_sampleTime));
+
+	m_sample = count;
+	m_sampleTime = time;
+}
+
+int32_t QEI :: velocity(void)
+{
+	return m_velocity;
+}
+
 extern "C"
 {
+	void TIM1_BRK_IRQHandler(void)
+	{
+		if((TIM1->SR & TIM_SR_BIF) != 0) {
+			// Interrupt disabled until break is re-armed (level sensitive flag)
+			TIM1->DIER &= ~TIM_DIER_BIE;
+			TIM1->SR = ~TIM_SR_BIF; // rc_w0
+
+			// Callback ?
+			if(breakCallback != 0)
+				(*breakCallback)();
+		}
+	}
+
 	void TIM1_UP_IRQHandler(void)
 	{
 		if((TIM1->SR & TIM_SR_UIF) != 0) {
@@ -335,6 +1053,17 @@ extern "C"
 		}
 	}
 
+	void TIM1_CC_IRQHandler(void)
+	{
+		if((TIM1->SR & TIM1->DIER & (TIM_SR_CC3IF | TIM_SR_CC4IF)) != 0) {
+			TIM1->SR = ~(TIM_SR_CC3IF | TIM_SR_CC4IF); // rc_w0
+
+			// Callback ?
+			if(compareCallback[0] != 0)
+				(*compareCallback[0])();
+		}
+	}
+
 	void TIM2_IRQHandler(void)
 	{
 		if((TIM2->SR & TIM_SR_UIF) != 0) {
@@ -344,6 +1073,14 @@ extern "C"
 
 			TIM2->SR &= ~TIM_SR_UIF;
 		}
+
+		if((TIM2->SR & TIM2->DIER & (TIM_SR_CC3IF | TIM_SR_CC4IF)) != 0) {
+			TIM2->SR = ~(TIM_SR_CC3IF | TIM_SR_CC4IF); // rc_w0
+
+			// Callback ?
+			if(compareCallback[1] != 0)
+				(*compareCallback[1])();
+		}
 	}
 
 	void TIM3_IRQHandler(void)
@@ -355,6 +1092,14 @@ extern "C"
 
 			TIM3->SR &= ~TIM_SR_UIF;
 		}
+
+		if((TIM3->SR & TIM3->DIER & (TIM_SR_CC3IF | TIM_SR_CC4IF)) != 0) {
+			TIM3->SR = ~(TIM_SR_CC3IF | TIM_SR_CC4IF); // rc_w0
+
+			// Callback ?
+			if(compareCallback[2] != 0)
+				(*compareCallback[2])();
+		}
 	}
 
 	void TIM4_IRQHandler(void)
@@ -366,5 +1111,13 @@ extern "C"
 
 			TIM4->SR &= ~TIM_SR_UIF;
 		}
+
+		if((TIM4->SR & TIM4->DIER & (TIM_SR_CC3IF | TIM_SR_CC4IF)) != 0) {
+			TIM4->SR = ~(TIM_SR_CC3IF | TIM_SR_CC4IF); // rc_w0
+
+			// Callback ?
+			if(compareCallback[3] != 0)
+				(*compareCallback[3])();
+		}
 	}
 }
@@ -48,6 +48,7 @@
 
 /* Exported functions prototypes ---------------------------------------------*/
 uint32_t SysTick_Value(void);
+uint64_t SysTick_Micros(void); // Monotonic microseconds (ms tick extended by SysTick counter)
 
 void NMI_Handler(void);
 void HardFault_Handler(void);
@@ -43,6 +43,7 @@
 /* Private variables ---------------------------------------------------------*/
 /* USER CODE BEGIN PV */
 __IO uint32_t sysTick = 0;
+__IO uint32_t sysTickHigh = 0;
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
@@ -56,6 +57,32 @@ uint32_t SysTick_Value(void)
 {
 	return sysTick;
 }
+
+uint64_t SysTick_Micros(void)
+{
+	uint32_t tick = 0;
+	uint32_t low = 0;
+	uint32_t high = 0;
+	uint32_t load = SysTick->LOAD;
+	uint32_t value = 0;
+
+	// Retry if the tick interrupt ran meanwhile (thread context)
+	do {
+		tick = sysTick;
+		high = sysTickHigh;
+		low = tick;
+		value = SysTick->VAL;
+
+		// Reload not serviced yet (interrupts masked or higher priority context)
+		if((SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) != 0) {
+			value = SysTick->VAL;
+			if(++low == 0) high++;
+		}
+	} while(tick != sysTick);
+
+	// Milliseconds x 1000 + elapsed part of the current millisecond (down counter)
+	return ((((uint64_t)high << 32) | low) * 1000) + (((load - value) * 1000) / (load + 1));
+}
 /* USER CODE END 0 */
 
 /* External variables --------------------------------------------------------*/
@@ -188,7 +215,7 @@ void SysTick_Handler(void)
 {
   /* USER CODE BEGIN SysTick_IRQn 0 */
 	HAL_IncTick();
-	sysTick++;
+	if(++sysTick == 0) sysTickHigh++;
   /* USER CODE END SysTick_IRQn 0 */
   
   /* USER CODE BEGIN SysTick_IRQn 1 */
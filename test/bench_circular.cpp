@@ -0,0 +1,137 @@
+/*!
+ * \file bench_circular.cpp
+ * \brief CircularBuffer host benchmark.
+ * \author Remi.Debord
+ * \version 1.0
+ * \date 17 octobre 2026
+ *
+ * Cycles per byte through the buffer (put then get, 64 bytes at a time) for the
+ * previous class (pointer + runtime size, one byte per call, shared counter) and
+ * CircularBuffer<T, N> (single and bulk access). Host timestamp counter: compare
+ * the ratios, not the absolute values, with the Cortex-M3.
+ *
+ */
+
+#include "CircularBuffer.h"
+
+#include <stdio.h>
+
+#define SIZE     (256)
+#define BLOCK    (64)
+#define ROUNDS   (200000)
+
+// Previous implementation (mask corrected: m_size - 1)
+class LegacyBuffer
+{
+	private:
+
+		__IO uint16_t m_read;
+		__IO uint16_t m_write;
+		__IO uint16_t m_count;
+		__IO uint16_t m_size;
+		__IO uint8_t* m_buffer;
+
+	public:
+
+		LegacyBuffer(uint8_t* buffer, uint16_t size)
+		{
+			m_read = 0;
+			m_write = 0;
+			m_count = 0;
+			m_buffer = buffer;
+			m_size = size;
+		}
+
+		void put(uint8_t c)
+		{
+			if(m_count < m_size) {
+				m_buffer[m_write] = c;
+				m_write = ((m_write + 1) & (m_size - 1));
+				m_count++;
+			}
+		}
+
+		uint8_t get(void)
+		{
+			uint8_t c = m_buffer[m_read];
+
+			m_read = ((m_read + 1) & (m_size - 1));
+			if(m_count) m_count--;
+
+			return c;
+		}
+};
+
+static uint8_t legacyData[SIZE];
+static LegacyBuffer legacy(legacyData, SIZE);
+static CircularBuffer<uint8_t, SIZE> ring;
+
+static uint8_t input[BLOCK];
+static uint8_t output[BLOCK];
+static volatile uint8_t sink = 0;
+
+static double bench_legacy(void)
+{
+	uint64_t start = host_cycles();
+	uint32_t r = 0;
+	uint16_t i = 0;
+
+	for(r = 0; r < ROUNDS; r++) {
+		for(i = 0; i < BLOCK; i++) legacy.put(input[i]);
+		for(i = 0; i < BLOCK; i++) output[i] = legacy.get();
+	}
+
+	sink = output[BLOCK - 1];
+
+	return (double)(host_cycles() - start) / ((double)ROUNDS * BLOCK);
+}
+
+static double bench_single(void)
+{
+	uint64_t start = host_cycles();
+	uint32_t r = 0;
+	uint16_t i = 0;
+
+	for(r = 0; r < ROUNDS; r++) {
+		for(i = 0; i < BLOCK; i++) ring.put(input[i]);
+		for(i = 0; i < BLOCK; i++) output[i] = ring.get();
+	}
+
+	sink = output[BLOCK - 1];
+
+	return (double)(host_cycles() - start) / ((double)ROUNDS * BLOCK);
+}
+
+static double bench_bulk(void)
+{
+	uint64_t start = host_cycles();
+	uint32_t r = 0;
+
+	for(r = 0; r < ROUNDS; r++) {
+		ring.put(input, BLOCK);
+		ring.get(output, BLOCK);
+	}
+
+	sink = output[BLOCK - 1];
+
+	return (double)(host_cycles() - start) / ((double)ROUNDS * BLOCK);
+}
+
+int main(void)
+{
+	uint16_t i = 0;
+
+	for(i = 0; i < BLOCK; i++) input[i] = (uint8_t)i;
+
+	// Warm up
+	bench_legacy();
+	bench_single();
+	bench_bulk();
+
+	printf("cycles/byte (put + get, %u bytes per round)\n", BLOCK);
+	printf("  previous class, per byte     : %6.2f\n", bench_legacy());
+	printf("  CircularBuffer<T, N>, per byte: %6.2f\n", bench_single());
+	printf("  CircularBuffer<T, N>, bulk    : %6.2f\n", bench_bulk());
+
+	return 0;
+}
@@ -0,0 +1,139 @@
+/*!
+ * \file bench_softtimer.cpp
+ * \brief SoftTimer host benchmark.
+ * \author Remi.Debord
+ * \version 1.0
+ * \date 17 octobre 2026
+ *
+ * Cycles per start (re-arm of an active timer: unlink + insert), per cancel and per
+ * expiry (callback, cascades and periodic re-insert, empty wheel tick deducted) with
+ * 10, 100 and 1000 active timers (random delays up to 2^17 ticks, over the 3 lower wheel levels). Host
+ * timestamp counter: costs should not grow with the number of timers.
+ *
+ */
+
+#include "SoftTimer.h"
+
+#include <stdio.h>
+
+#define TIMERS_MAX  1000
+#define DELAY_MAX   (1UL << 17)
+#define STARTS      200000
+#define TICKS       (1UL << 18)
+
+static SoftTimer timers[TIMERS_MAX];
+static uint32_t seed = 1;
+static volatile uint32_t expired = 0;
+
+static uint32_t next(void)
+{
+	seed = (seed * 1103515245UL) + 12345UL;
+
+	return (seed >> 8);
+}
+
+static void event(void* context)
+{
+	(void)context;
+
+	expired++;
+}
+
+static double bench_start(uint16_t count)
+{
+	uint64_t start = 0;
+	uint32_t i = 0;
+
+	for(i = 0; i < count; i++) timers[i].once(&event, 0, 1 + (next() % DELAY_MAX));
+
+	start = host_cycles();
+
+	for(i = 0; i < STARTS; i++) timers[i % count].once(&event, 0, 1 + (next() % DELAY_MAX));
+
+	return (double)(host_cycles() - start) / STARTS;
+}
+
+static double bench_cancel(uint16_t count)
+{
+	uint64_t start = 0;
+	uint64_t cycles = 0;
+	uint32_t r = 0;
+	uint16_t i = 0;
+
+	for(r = 0; r < (STARTS / count); r++) {
+		for(i = 0; i < count; i++) timers[i].once(&event, 0, 1 + (next() % DELAY_MAX));
+
+		start = host_cycles();
+
+		for(i = 0; i < count; i++) timers[i].cancel();
+
+		cycles += host_cycles() - start;
+	}
+
+	return (double)cycles / ((STARTS / count) * count);
+}
+
+// Empty wheel: slot scan and cascades only
+static double bench_tick(void)
+{
+	uint64_t start = host_cycles();
+	uint32_t i = 0;
+
+	for(i = 0; i < TICKS; i++) SoftTimer::tick();
+
+	return (double)(host_cycles() - start) / TICKS;
+}
+
+// Per expiry: tick time above the empty wheel one
+static double bench_expire(uint16_t count, double empty, double* tick)
+{
+	uint64_t start = 0;
+	uint64_t cycles = 0;
+	uint32_t i = 0;
+
+	// Periodic timers: count x TICKS / average period expiries
+	for(i = 0; i < count; i++) timers[i].every(&event, 0, 1 + (next() % (DELAY_MAX / 64)));
+
+	expired = 0;
+	start = host_cycles();
+
+	for(i = 0; i < TICKS; i++) SoftTimer::tick();
+
+	cycles = host_cycles() - start;
+
+	for(i = 0; i < count; i++) timers[i].cancel();
+
+	*tick = (double)cycles / TICKS;
+
+	return (expired != 0) ? (((double)cycles - (empty * TICKS)) / expired) : 0;
+}
+
+int main(void)
+{
+	static const uint16_t counts[] = {10, 100, 1000};
+
+	double empty = 0;
+	double tick = 0;
+	uint8_t i = 0;
+
+	// Warm up
+	bench_start(TIMERS_MAX);
+	bench_cancel(TIMERS_MAX);
+	bench_tick();
+
+	empty = bench_tick();
+
+	printf("cycles (active timers, delays 1 to %lu ticks)\n", DELAY_MAX);
+	printf("  empty wheel tick: %.1f\n", empty);
+	printf("  timers     start    cancel    expiry      tick\n");
+
+	for(i = 0; i < 3; i++) {
+		double start = bench_start(counts[i]);
+		double cancel = bench_cancel(counts[i]);
+		double expiry = bench_expire(counts[i], empty, &tick);
+
+		printf("  %6u  %8.1f  %8.1f  %8.1f  %8.1f\n", counts[i], start, cancel, expiry, tick);
+	}
+
+	return 0;
+}
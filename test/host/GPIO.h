@@ -0,0 +1,2 @@
+/* Host build: header case as spelled by the library sources */
+#include "Gpio.h"
@@ -0,0 +1,219 @@
+/*!
+ * \file host.cpp
+ * \brief Host test support.
+ * \author Remi.Debord
+ * \version 1.0
+ * \date 17 octobre 2026
+ *
+ * Peripheral address ranges are mapped as RAM before any constructor runs.
+ * Write tracing: pages are write protected, each faulting store is single
+ * stepped then logged with the resulting register value. Access hook: page
+ * not accessible, hook called before the faulting access is single stepped.
+ *
+ */
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#include "stm32f1xx.h"
+
+extern "C"
+{
+	uint32_t hostPrimask = 0;
+	uint64_t hostMicros = 0;
+	uint32_t SystemCoreClock = 72000000;
+	const uint8_t AHBPrescTable[16] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 4, 6, 7, 8, 9};
+	const uint8_t APBPrescTable[8] = {0, 0, 0, 0, 1, 2, 3, 4};
+
+	__attribute__((weak)) uint64_t SysTick_Micros(void)
+	{
+		return hostMicros;
+	}
+}
+
+static const struct {
+	uint32_t base;
+	uint32_t size;
+} regions[] = {
+	{PERIPH_BASE, 0x00030000},   // APB1, APB2, AHB (DMA, RCC, FLASH, CRC)
+	{0xE0000000, 0x00100000}     // System control space (SysTick, NVIC, SCB), DBGMCU
+};
+
+static HostWrite trace[HOST_TRACE_MAX];
+static volatile uint16_t traceCount = 0;
+static uint32_t traceBase = 0;
+static uint32_t traceSize = 0;
+static uintptr_t tracePage = 0;
+static uintptr_t traceAddress = 0;
+
+static void (*hook)(uint16_t) = 0;
+static uint32_t hookAddress = 0;
+static uint16_t hookCount = 0;
+
+static int failures = 0;
+static int checks = 0;
+
+static void protect(int flags)
+{
+	uintptr_t page = traceBase & ~((uintptr_t)0xFFF);
+
+	mprotect((void*)page, ((traceBase + traceSize) - page + 0xFFF) & ~((uintptr_t)0xFFF), flags);
+}
+
+static void segv(int sig, siginfo_t* info, void* context)
+{
+	ucontext_t* uc = (ucontext_t*)context;
+	uintptr_t address = (uintptr_t)info->si_addr;
+
+	(void)sig;
+
+	// Hooked page: any access single stepped, hook called on the register itself
+	if((hook != 0) && ((address & ~((uintptr_t)0xFFF)) == (hookAddress & ~((uintptr_t)0xFFF)))) {
+		tracePage = address & ~((uintptr_t)0xFFF);
+		mprotect((void*)tracePage, 0x1000, PROT_READ | PROT_WRITE);
+
+		if((address & ~((uintptr_t)0x03)) == hookAddress) (*hook)(hookCount++);
+
+		uc->uc_mcontext.gregs[REG_EFL] |= 0x100;
+		return;
+	}
+
+	if((traceSize == 0) || (address < (traceBase & ~((uintptr_t)0xFFF))) || (address >= (traceBase + traceSize))) {
+		fprintf(stderr, "host: invalid access at %p\n", info->si_addr);
+		_exit(2);
+	}
+
+	// Unprotect, execute the store alone (trap flag), log it on SIGTRAP
+	tracePage = address & ~((uintptr_t)0xFFF);
+	traceAddress = address & ~((uintptr_t)0x03);
+	mprotect((void*)tracePage, 0x1000, PROT_READ | PROT_WRITE);
+
+	uc->uc_mcontext.gregs[REG_EFL] |= 0x100;
+}
+
+static void trap(int sig, siginfo_t* info, void* context)
+{
+	ucontext_t* uc = (ucontext_t*)context;
+
+	(void)sig;
+	(void)info;
+
+	uc->uc_mcontext.gregs[REG_EFL] &= ~0x100;
+
+	if(hook != 0) {
+		mprotect((void*)tracePage, 0x1000, PROT_NONE);
+		return;
+	}
+
+	if((traceAddress >= traceBase) && (traceAddress < (traceBase + traceSize)) && (traceCount < HOST_TRACE_MAX)) {
+		trace[traceCount].address = (uint32_t)traceAddress;
+		trace[traceCount].value = *(volatile uint32_t*)traceAddress;
+		traceCount++;
+	}
+
+	mprotect((void*)tracePage, 0x1000, PROT_READ);
+}
+
+__attribute__((constructor(101))) static void host_init(void)
+{
+	struct sigaction action;
+	uint8_t i = 0;
+
+	for(i = 0; i < (sizeof(regions) / sizeof(regions[0])); i++) {
+		void* p = mmap((void*)(uintptr_t)regions[i].base, regions[i].size, PROT_READ | PROT_WRITE,
+		               MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+
+		if(p != (void*)(uintptr_t)regions[i].base) {
+			fprintf(stderr, "host: cannot map 0x%08X (%s)\n", regions[i].base, strerror(errno));
+			exit(2);
+		}
+	}
+
+	memset(&action, 0, sizeof(action));
+	action.sa_flags = SA_SIGINFO;
+
+	action.sa_sigaction = &segv;
+	sigaction(SIGSEGV, &action, 0);
+
+	action.sa_sigaction = &trap;
+	sigaction(SIGTRAP, &action, 0);
+}
+
+extern "C" void host_reset(void)
+{
+	uint8_t i = 0;
+
+	for(i = 0; i < (sizeof(regions) / sizeof(regions[0])); i++)
+		memset((void*)(uintptr_t)regions[i].base, 0, regions[i].size);
+}
+
+extern "C" void host_trace_start(uint32_t base, uint32_t size)
+{
+	traceCount = 0;
+	traceBase = base;
+	traceSize = size;
+
+	protect(PROT_READ);
+}
+
+extern "C" uint16_t host_trace_stop(HostWrite** writes)
+{
+	protect(PROT_READ | PROT_WRITE);
+
+	traceSize = 0;
+
+	if(writes != 0) *writes = trace;
+
+	return traceCount;
+}
+
+extern "C" int16_t host_trace_find(uint32_t address, uint32_t mask, uint32_t bits, int16_t from)
+{
+	int16_t i = 0;
+
+	for(i = (from < 0) ? 0 : from; i < (int16_t)traceCount; i++) {
+		if((trace[i].address == address) && ((trace[i].value & mask) == (bits & mask)))
+			return i;
+	}
+
+	return -1;
+}
+
+extern "C" void host_hook_start(uint32_t address, void(*f)(uint16_t))
+{
+	hookAddress = address & ~((uint32_t)0x03);
+	hookCount = 0;
+	hook = f;
+
+	mprotect((void*)(uintptr_t)(hookAddress & ~((uint32_t)0xFFF)), 0x1000, PROT_NONE);
+}
+
+extern "C" void host_hook_stop(void)
+{
+	mprotect((void*)(uintptr_t)(hookAddress & ~((uint32_t)0xFFF)), 0x1000, PROT_READ | PROT_WRITE);
+
+	hook = 0;
+}
+
+extern "C" void host_check(int condition, const char* expression, const char* file, int line)
+{
+	checks++;
+
+	if(condition == 0) {
+		failures++;
+		printf("%s:%d: check failed: %s\n", file, line, expression);
+	}
+}
+
+extern "C" int host_result(void)
+{
+	printf("%d checks, %d failed\n", checks, failures);
+
+	return (failures != 0);
+}
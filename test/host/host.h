@@ -0,0 +1,102 @@
+#ifndef __HOST_H
+#define __HOST_H
+
+/*!
+ * \file host.h
+ * \brief Host test support.
+ * \author Remi.Debord
+ * \version 1.0
+ * \date 17 octobre 2026
+ *
+ * Forced include (-include host.h) replacing the Cortex-M3 intrinsics so the library
+ * sources build on the host. Peripheral registers are plain memory mapped at their
+ * device addresses (host.cpp), register writes can be traced in order.
+ *
+ */
+
+/* includes ---------------------------------------------------------------- */
+#include <stdint.h>
+
+/* defines ----------------------------------------------------------------- */
+#define __CMSIS_GCC_H // cmsis_gcc.h replaced
+
+#define __ASM                   __asm
+#define __INLINE                inline
+#define __STATIC_INLINE         static inline
+#define __STATIC_FORCEINLINE    static inline
+#define __NO_RETURN             __attribute__((__noreturn__))
+#define __USED                  __attribute__((used))
+#define __WEAK                  __attribute__((weak))
+#define __PACKED                __attribute__((packed, aligned(1)))
+#define __PACKED_STRUCT         struct __attribute__((packed, aligned(1)))
+#define __PACKED_UNION          union __attribute__((packed, aligned(1)))
+#define __ALIGNED(x)            __attribute__((aligned(x)))
+#define __RESTRICT              __restrict
+#define __COMPILER_BARRIER()    __asm volatile("":::"memory")
+
+#define __NOP()                 ((void)0)
+#define __WFI()                 ((void)0)
+#define __WFE()                 ((void)0)
+#define __SEV()                 ((void)0)
+#define __DSB()                 __sync_synchronize()
+#define __ISB()                 __sync_synchronize()
+#define __DMB()                 __COMPILER_BARRIER() // x86 (TSO): no store/store or load/load reordering
+
+#define HOST_TRACE_MAX          (256)
+
+/* struct ------------------------------------------------------------------ */
+typedef struct {
+	uint32_t address;
+	uint32_t value;   // Register value after the write
+} HostWrite;
+
+/* functions --------------------------------------------------------------- */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern uint32_t hostPrimask;
+extern uint64_t hostMicros;   // SysTick_Micros() value (stub, weak: stm32f1xx_it.c linked instead)
+
+static inline uint32_t __get_PRIMASK(void) { return hostPrimask; }
+static inline void __set_PRIMASK(uint32_t value) { hostPrimask = value; }
+static inline void __disable_irq(void) { hostPrimask = 1; }
+static inline void __enable_irq(void) { hostPrimask = 0; }
+
+// Host timestamp counter (benchmarks)
+static inline uint64_t host_cycles(void)
+{
+	uint32_t low = 0;
+	uint32_t high = 0;
+
+	__asm volatile("rdtsc" : "=a"(low), "=d"(high));
+
+	return (((uint64_t)high << 32) | low);
+}
+
+// Peripheral memory (APB1, APB2, AHB and system control space) cleared
+void host_reset(void);
+
+// Record every write between start and stop (address range: [base, base + size[)
+void host_trace_start(uint32_t base, uint32_t size);
+uint16_t host_trace_stop(HostWrite** writes);
+
+// Index of the first write to address with (value & mask) == (bits & mask) after index from, -1: none
+int16_t host_trace_find(uint32_t address, uint32_t mask, uint32_t bits, int16_t from);
+
+// f(count) called before each access (read or write, count from 0) to the register at address,
+// ex: counter reload or interrupt between two reads (not combined with write tracing)
+void host_hook_start(uint32_t address, void(*f)(uint16_t));
+void host_hook_stop(void);
+
+// Test report
+void host_check(int condition, const char* expression, const char* file, int line);
+int host_result(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#define CHECK(x) host_check((x) != 0, #x, __FILE__, __LINE__)
+
+#endif /* __HOST_H */
@@ -0,0 +1,242 @@
+/*!
+ * \file test_adc.cpp
+ * \brief AnalogIn host test.
+ * \author Remi.Debord
+ * \version 1.0
+ * \date 17 octobre 2026
+ *
+ * Regular sequence (16 ranks, external and internal channels), timer trigger and
+ * injected group against the ADC register mock. Register writes are traced to check
+ * the programming order: ADC stopped while reconfigured, enabled last.
+ *
+ */
+
+#include "Analog.h"
+
+#define TRACE_BASE  ADC1_BASE                          // ADC1, ADC2, ..., DMA1
+#define TRACE_SIZE  ((DMA1_BASE + 0x100) - ADC1_BASE)
+
+static AnalogIn* in[16];
+
+static uint16_t injectedValues[ADC_INJECTED_MAX];
+static uint8_t injectedCount = 0;
+
+static void injected(uint16_t* values, uint8_t count)
+{
+	uint8_t i = 0;
+
+	for(i = 0; i < count; i++) injectedValues[i] = values[i];
+	injectedCount = count;
+}
+
+// Channel programmed at a rank (0 to 15)
+static uint8_t sq(ADC_TypeDef* adc, uint8_t rank)
+{
+	if(rank < 6) return (adc->SQR3 >> (rank * 5)) & 0x1F;
+	if(rank < 12) return (adc->SQR2 >> ((rank - 6) * 5)) & 0x1F;
+
+	return (adc->SQR1 >> ((rank - 12) * 5)) & 0x1F;
+}
+
+static uint8_t smp(ADC_TypeDef* adc, uint8_t channel)
+{
+	if(channel >= 10) return (adc->SMPR1 >> ((channel - 10) * 3)) & 0x07;
+
+	return (adc->SMPR2 >> (channel * 3)) & 0x07;
+}
+
+// ADON cleared < configuration write < ADON set < SWSTART
+static void check_order(uint32_t address, uint32_t mask, uint32_t bits)
+{
+	int16_t off = host_trace_find(ADC1_BASE + offsetof(ADC_TypeDef, CR2), ADC_CR2_ADON, 0, 0);
+	int16_t config = host_trace_find(address, mask, bits, off);
+	int16_t on = host_trace_find(ADC1_BASE + offsetof(ADC_TypeDef, CR2), ADC_CR2_ADON, ADC_CR2_ADON, config);
+
+	CHECK(off >= 0);
+	CHECK(config > off);
+	CHECK(on > config);
+	CHECK(host_trace_find(ADC1_BASE + offsetof(ADC_TypeDef, CR2), ADC_CR2_SWSTART, ADC_CR2_SWSTART, on + 1) > on);
+}
+
+static void test_sequence(void)
+{
+	static const PinName pins[] = {PA_0, PA_1, PA_2, PA_3, PA_4, PA_5, PA_6, PA_7, PB_0, PB_1, PC_0, PC_1, PC_2, PC_3};
+	static const uint8_t channels[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13};
+	uint8_t i = 0;
+
+	// Not an analog pin
+	AnalogIn none(PA_8);
+	CHECK(AnalogIn::ranks() == 0);
+	CHECK(none.read() == 0);
+
+	for(i = 0; i < 14; i++) {
+		// Last external channel: programming order
+		if(i == 13) host_trace_start(TRACE_BASE, TRACE_SIZE);
+
+		in[i] = new AnalogIn(pins[i]);
+
+		if(i == 13) {
+			host_trace_stop(0);
+
+			// Rank 14 (SQR3: 1-6, SQR2: 7-12, SQR1: 13-16) and length programmed while stopped
+			check_order(ADC1_BASE + offsetof(ADC_TypeDef, SQR1), ADC_SQR1_SQ14, 13 << ADC_SQR1_SQ14_Pos);
+			check_order(ADC1_BASE + offsetof(ADC_TypeDef, SQR1), ADC_SQR1_L, 13 << ADC_SQR1_L_Pos);
+			check_order(ADC1_BASE + offsetof(ADC_TypeDef, SMPR1), ADC_SMPR1_SMP13, ADC_SMPR1_SMP13);
+
+			// DMA restarted on all ranks before conversion starts
+			check_order(DMA1_Channel1_BASE + offsetof(DMA_Channel_TypeDef, CNDTR), 0xFFFF, 14);
+		}
+	}
+
+	// Internal channels: ranks 15 and 16
+	in[14] = new AnalogIn(Adc_Temperature);
+	in[15] = new AnalogIn(Adc_Vrefint);
+
+	CHECK(AnalogIn::ranks() == 16);
+	CHECK((ADC1->CR2 & ADC_CR2_TSVREFE) != 0);
+
+	for(i = 0; i < 14; i++) {
+		CHECK(in[i]->rank() == i);
+		CHECK(sq(ADC1, i) == channels[i]);
+		CHECK(smp(ADC1, channels[i]) == Sample_239_5);
+	}
+
+	CHECK(sq(ADC1, 14) == 16);
+	CHECK(sq(ADC1, 15) == 17);
+	CHECK(smp(ADC1, 16) == Sample_239_5);
+	CHECK(smp(ADC1, 17) == Sample_239_5);
+
+	// 16 conversions, scan, continuous, DMA on all ranks
+	CHECK(((ADC1->SQR1 & ADC_SQR1_L) >> ADC_SQR1_L_Pos) == 15);
+	CHECK((ADC1->CR1 & ADC_CR1_SCAN) != 0);
+	CHECK((ADC1->CR2 & (ADC_CR2_CONT | ADC_CR2_DMA | ADC_CR2_ADON)) == (ADC_CR2_CONT | ADC_CR2_DMA | ADC_CR2_ADON));
+	CHECK(DMA1_Channel1->CNDTR == 16);
+	CHECK(DMA1_Channel1->CPAR == (uint32_t)(uintptr_t)&ADC1->DR);
+
+	// Sequence full
+	AnalogIn extra(PC_4);
+	CHECK(AnalogIn::ranks() == 16);
+	CHECK(extra.read() == 0);
+
+	// Results by rank
+	((uint16_t*)(uintptr_t)DMA1_Channel1->CMAR)[13] = 1234;
+	CHECK(in[13]->read() == 1234);
+
+	// Sampling time per channel
+	in[3]->sample_time(Sample_7_5);
+	CHECK(smp(ADC1, 3) == Sample_7_5);
+	CHECK(smp(ADC1, 4) == Sample_239_5);
+}
+
+static void test_trigger(void)
+{
+	Timer timer(TIM3);
+
+	host_trace_start(TRACE_BASE, TRACE_SIZE);
+
+	CHECK(AnalogIn::trigger(&timer, 1000) == 1000); // 72MHz / 72000
+
+	host_trace_stop(0);
+
+	// Single scan per TIM3 TRGO (EXTSEL = 100), programmed while stopped
+	CHECK((ADC1->CR2 & ADC_CR2_CONT) == 0);
+	CHECK((ADC1->CR2 & ADC_CR2_EXTSEL) == ADC_CR2_EXTSEL_2);
+	CHECK((ADC1->CR2 & ADC_CR2_EXTTRIG) != 0);
+	check_order(ADC1_BASE + offsetof(ADC_TypeDef, CR2), ADC_CR2_CONT, 0);
+	check_order(ADC1_BASE + offsetof(ADC_TypeDef, CR2), ADC_CR2_EXTSEL, ADC_CR2_EXTSEL_2);
+	check_order(DMA1_Channel1_BASE + offsetof(DMA_Channel_TypeDef, CNDTR), 0xFFFF, 16);
+
+	// TIM3: update event as TRGO
+	CHECK((TIM3->CR2 & TIM_CR2_MMS) == TIM_CR2_MMS_1);
+	CHECK((TIM3->CR1 & TIM_CR1_CEN) != 0);
+
+	AnalogIn::trigger_stop();
+
+	CHECK((ADC1->CR2 & ADC_CR2_CONT) != 0);
+	CHECK((ADC1->CR2 & ADC_CR2_EXTSEL) == ADC_CR2_EXTSEL);
+}
+
+static void test_injected(void)
+{
+	PinName pins[2] = {PA_6, PB_1};
+	Timer timer(TIM1);
+
+	host_trace_start(TRACE_BASE, TRACE_SIZE);
+
+	CHECK(AnalogIn::injected(pins, 2, Sample_13_5, &timer, &injected) == 1);
+
+	host_trace_stop(0);
+
+	// JSQ3, JSQ4 (2 conversions), TIM1 TRGO (JEXTSEL = 000)
+	CHECK(((ADC1->JSQR & ADC_JSQR_JSQ3) >> ADC_JSQR_JSQ3_Pos) == 6);
+	CHECK(((ADC1->JSQR & ADC_JSQR_JSQ4) >> ADC_JSQR_JSQ4_Pos) == 9);
+	CHECK(((ADC1->JSQR & ADC_JSQR_JL) >> ADC_JSQR_JL_Pos) == 1);
+	CHECK((ADC1->CR2 & ADC_CR2_JEXTSEL) == 0);
+	CHECK((ADC1->CR2 & ADC_CR2_JEXTTRIG) != 0);
+	CHECK((ADC1->CR1 & ADC_CR1_JEOCIE) != 0);
+	CHECK(smp(ADC1, 6) == Sample_13_5);
+	CHECK(smp(ADC1, 9) == Sample_13_5);
+	check_order(ADC1_BASE + offsetof(ADC_TypeDef, JSQR), ADC_JSQR_JL, ADC_JSQR_JL_0);
+	check_order(ADC1_BASE + offsetof(ADC_TypeDef, CR1), ADC_CR1_JEOCIE, ADC_CR1_JEOCIE);
+
+	CHECK((TIM1->CR2 & TIM_CR2_MMS) == TIM_CR2_MMS_1);
+
+	// End of injected sequence: results in pins order
+	ADC1->JDR1 = 111;
+	ADC1->JDR2 = 222;
+	ADC1->SR = ADC_SR_JEOC;
+	AnalogIn::irq();
+
+	CHECK(injectedCount == 2);
+	CHECK(injectedValues[0] == 111);
+	CHECK(injectedValues[1] == 222);
+	CHECK((ADC1->SR & ADC_SR_JEOC) == 0);
+
+	AnalogIn::injected_stop();
+	CHECK((ADC1->CR1 & ADC_CR1_JEOCIE) == 0);
+}
+
+static void test_dual(void)
+{
+	static uint16_t block[(2 * 2 * 16) + 2] __ALIGNED(4);
+
+	// ADC2 sampling PC5 with rank 0
+	in[0]->pair(PC_5);
+
+	CHECK((ADC1->CR1 & ADC_CR1_DUALMOD) == (ADC_CR1_DUALMOD_1 | ADC_CR1_DUALMOD_2));
+	CHECK((ADC2->SQR3 & ADC_SQR3_SQ1) == 15);
+	CHECK((ADC2->SQR1 & ADC_SQR1_L) == (ADC1->SQR1 & ADC_SQR1_L));
+	CHECK((ADC2->CR2 & ADC_CR2_ADON) != 0);
+
+	// Snapshot: 32 bits transfers (ADC1, ADC2) to a 4-byte aligned buffer
+	CHECK((DMA1_Channel1->CCR & DMA_CCR_MSIZE) == DMA_CCR_MSIZE_1);
+	CHECK((DMA1_Channel1->CCR & DMA_CCR_PSIZE) == DMA_CCR_PSIZE_1);
+	CHECK((DMA1_Channel1->CMAR & 0x03) == 0);
+
+	((uint32_t*)(uintptr_t)DMA1_Channel1->CMAR)[0] = (2222 << 16) | 1111;
+	CHECK(in[0]->read() == 1111);
+	CHECK(in[0]->read_pair() == 2222);
+
+	// Block: misaligned buffer ignored
+	AnalogIn::block(&block[1], 1, 0);
+	CHECK(DMA1_Channel1->CMAR != (uint32_t)(uintptr_t)&block[1]);
+	CHECK(DMA1_Channel1->CNDTR == 16);
+
+	AnalogIn::block(&block[0], 1, 0);
+	CHECK(DMA1_Channel1->CMAR == (uint32_t)(uintptr_t)&block[0]);
+	CHECK(DMA1_Channel1->CNDTR == (2 * 16));
+	CHECK((DMA1_Channel1->CCR & DMA_CCR_MSIZE) == DMA_CCR_MSIZE_1);
+
+	AnalogIn::block_stop();
+	CHECK(DMA1_Channel1->CNDTR == 16);
+}
+
+int main(void)
+{
+	test_sequence();
+	test_trigger();
+	test_injected();
+	test_dual();
+
+	return host_result();
+}
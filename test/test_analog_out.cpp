@@ -0,0 +1,135 @@
+/*!
+ * \file test_analog_out.cpp
+ * \brief AnalogOut host test.
+ * \author Remi.Debord
+ * \version 1.0
+ * \date 17 octobre 2026
+ *
+ * 12 bits PWM configuration and compare values written by write() and by the timer
+ * update DMA stream, against the TIM1/DMA1 register mock.
+ *
+ */
+
+#include "Analog.h"
+
+#define SAMPLES 8
+
+static uint16_t wave[SAMPLES] = {2048, 3495, 4095, 3495, 2048, 600, 0, 600};
+static uint16_t ccr[3 * SAMPLES];
+static uint16_t ccrCount = 0;
+
+// Timer update: DMA moves the next sample to the compare register (CMAR[length - CNDTR])
+static void update(void)
+{
+	uint16_t length = SAMPLES;
+	uint16_t index = length - (uint16_t)DMA1_Channel5->CNDTR;
+
+	if((DMA1_Channel5->CCR & DMA_CCR_EN) != 0) {
+		*(__IO uint32_t*)(uintptr_t)DMA1_Channel5->CPAR = ((uint16_t*)(uintptr_t)DMA1_Channel5->CMAR)[index];
+
+		if(--DMA1_Channel5->CNDTR == 0) {
+			if((DMA1_Channel5->CCR & DMA_CCR_CIRC) != 0) DMA1_Channel5->CNDTR = length;
+			else DMA1_Channel5->CCR &= ~DMA_CCR_EN;
+		}
+	}
+
+	// Preloaded compare value active for this period
+	ccr[ccrCount++] = (uint16_t)TIM1->CCR1;
+}
+
+static void test_setup(AnalogOut& out)
+{
+	// Full clock, 12 bits period
+	CHECK(TIM1->PSC == 0);
+	CHECK(TIM1->ARR == (ANALOGOUT_RANGE - 1));
+	CHECK(out.period() == ANALOGOUT_RANGE);
+	CHECK(out.frequency() == (SystemCoreClock / ANALOGOUT_RANGE));
+
+	// PWM1, compare preload, output enabled
+	CHECK((TIM1->CCMR1 & (TIM_CCMR1_OC1M | TIM_CCMR1_OC1PE)) == (TIM_CCMR1_OC1M_1 | TIM_CCMR1_OC1M_2 | TIM_CCMR1_OC1PE));
+	CHECK((TIM1->CCER & (TIM_CCER_CC1E | TIM_CCER_CC1P)) == TIM_CCER_CC1E);
+	CHECK((TIM1->CR1 & (TIM_CR1_ARPE | TIM_CR1_CEN)) == (TIM_CR1_ARPE | TIM_CR1_CEN));
+	CHECK((TIM1->BDTR & TIM_BDTR_MOE) != 0);
+	CHECK(TIM1->CCR1 == 0);
+
+	// PA8: alternate function push-pull
+	CHECK(((GPIOA->CRH >> GPIO_CRH_CNF8_Pos) & 0x03) == 0x02);
+}
+
+static void test_write(AnalogOut& out)
+{
+	HostWrite* writes = 0;
+	uint16_t count = 0;
+
+	host_trace_start(TIM1_BASE, 0x400);
+
+	out.write(1000);
+	out = 4095;
+	out = 5000;
+	out.write(0);
+
+	count = host_trace_stop(&writes);
+
+	// One compare value per write, overflow clamped to full scale
+	CHECK(count == 4);
+	CHECK(writes[0].address == (uint32_t)(uintptr_t)&TIM1->CCR1);
+	CHECK(writes[0].value == 1000);
+	CHECK(writes[1].value == 4095);
+	CHECK(writes[2].value == 4095);
+	CHECK(writes[3].value == 0);
+
+	out = 1234;
+	CHECK(out.read() == 1234);
+	CHECK((uint16_t)out == 1234);
+}
+
+static void test_stream(AnalogOut& out)
+{
+	Dma other;
+	uint16_t i = 0;
+
+	out = 100;
+
+	CHECK(out.stream(wave, SAMPLES, Dma_Circular, 0) == 1);
+
+	// Update DMA request to CCR1, 16 bits, memory to peripheral
+	CHECK((TIM1->DIER & TIM_DIER_UDE) != 0);
+	CHECK(DMA1_Channel5->CPAR == (uint32_t)(uintptr_t)&TIM1->CCR1);
+	CHECK(DMA1_Channel5->CMAR == (uint32_t)(uintptr_t)wave);
+	CHECK(DMA1_Channel5->CNDTR == SAMPLES);
+	CHECK((DMA1_Channel5->CCR & (DMA_CCR_DIR | DMA_CCR_CIRC | DMA_CCR_MINC | DMA_CCR_PINC)) == (DMA_CCR_DIR | DMA_CCR_CIRC | DMA_CCR_MINC));
+	CHECK((DMA1_Channel5->CCR & (DMA_CCR_PSIZE | DMA_CCR_MSIZE)) == (DMA_CCR_PSIZE_0 | DMA_CCR_MSIZE_0));
+
+	// One sample per PWM period, repeated
+	for(i = 0; i < (3 * SAMPLES); i++) update();
+
+	for(i = 0; i < (3 * SAMPLES); i++) CHECK(ccr[i] == wave[i % SAMPLES]);
+
+	// Channel owned while streaming
+	CHECK(other.open(Dma_TIM1_UP, Dma_MemoryToPeripheral, Dma_16bits, Dma_Low) == 0);
+
+	out.stream_stop();
+
+	// Channel released, back to the last written value
+	CHECK((TIM1->DIER & TIM_DIER_UDE) == 0);
+	CHECK((DMA1_Channel5->CCR & DMA_CCR_EN) == 0);
+	CHECK(TIM1->CCR1 == 100);
+	CHECK(other.open(Dma_TIM1_UP, Dma_MemoryToPeripheral, Dma_16bits, Dma_Low) == 1);
+
+	// Channel used by another peripheral
+	CHECK(out.stream(wave, SAMPLES, Dma_Circular, 0) == 0);
+	CHECK((TIM1->DIER & TIM_DIER_UDE) == 0);
+
+	other.close();
+}
+
+int main(void)
+{
+	AnalogOut out(PA_8, TIM1, Channel_1);
+
+	test_setup(out);
+	test_write(out);
+	test_stream(out);
+
+	return host_result();
+}
@@ -0,0 +1,261 @@
+/*!
+ * \file test_circular.cpp
+ * \brief CircularBuffer host test.
+ * \author Remi.Debord
+ * \version 1.0
+ * \date 17 octobre 2026
+ *
+ * Single producer / single consumer stress: a simulated ISR (periodic timer signal,
+ * preempting the main loop at any instruction) produces or consumes while the main loop
+ * does the other side, then both sides run in parallel threads. Data is a byte sequence, any
+ * loss, duplication or reordering is reported.
+ *
+ */
+
+#include "CircularBuffer.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/time.h>
+
+#define TOTAL    (1000000) // bytes per scenario
+#define CHUNK    (23)      // bulk size (not a power of 2: every wrap position)
+#define PERIOD   (5)       // simulated interrupt period (us)
+
+typedef CircularBuffer<uint8_t, 64> Buffer;
+
+static Buffer ring;
+
+static volatile uint32_t produced = 0;
+static volatile uint32_t consumed = 0;
+static volatile uint32_t errors = 0;
+static uint32_t isrSeed = 1;
+
+static uint32_t next(uint32_t* seed)
+{
+	*seed = (*seed * 1103515245) + 12345;
+
+	return (*seed >> 16);
+}
+
+// Producer step: single put, bulk put or reserve/commit
+static uint16_t produce(uint32_t seed)
+{
+	uint32_t start = produced;
+	uint8_t data[CHUNK];
+	uint8_t* span = 0;
+	uint16_t length = CHUNK;
+	uint16_t contiguous = 0;
+	uint16_t i = 0;
+
+	// Exactly TOTAL bytes
+	if((TOTAL - produced) < length) length = (uint16_t)(TOTAL - produced);
+	if(length == 0) return 0;
+
+	switch(seed % 3)
+	{
+		case 0:
+			if(ring.put((uint8_t)produced) != 0) produced++;
+			break;
+
+		case 1:
+			for(i = 0; i < length; i++) data[i] = (uint8_t)(produced + i);
+			produced += ring.put(data, length);
+			break;
+
+		default:
+			contiguous = ring.reserve(&span);
+			if(length > contiguous) length = contiguous;
+			for(i = 0; i < length; i++) span[i] = (uint8_t)(produced + i);
+			ring.commit(length);
+			produced += length;
+			break;
+	}
+
+	return (uint16_t)(produced - start);
+}
+
+// Consumer step: single get, bulk get, or peek/skip
+static uint16_t consume(uint32_t seed)
+{
+	uint32_t start = consumed;
+	uint8_t data[CHUNK];
+	uint8_t* span[2];
+	uint16_t lengths[2];
+	uint16_t length = 0;
+	uint16_t i = 0;
+
+	switch(seed % 3)
+	{
+		case 0:
+			if(ring.count() != 0) {
+				if(ring.get() != (uint8_t)consumed) errors++;
+				consumed++;
+			}
+			break;
+
+		case 1:
+			length = ring.get(data, CHUNK);
+			for(i = 0; i < length; i++)
+				if(data[i] != (uint8_t)(consumed + i)) errors++;
+			consumed += length;
+			break;
+
+		default:
+			length = ring.peek(span, lengths);
+			if(length > CHUNK) length = CHUNK;
+			for(i = 0; i < length; i++)
+				if(((i < lengths[0]) ? span[0][i] : span[1][i - lengths[0]]) != (uint8_t)(consumed + i)) errors++;
+			ring.skip(length);
+			consumed += length;
+			break;
+	}
+
+	return (uint16_t)(consumed - start);
+}
+
+static void isr_producer(int sig)
+{
+	(void)sig;
+
+	produce(next(&isrSeed));
+}
+
+static void isr_consumer(int sig)
+{
+	(void)sig;
+
+	consume(next(&isrSeed));
+}
+
+// Simulated interrupt: periodic signal on the main thread
+static void interrupt(void(*f)(int))
+{
+	struct itimerval timer;
+
+	timer.it_interval.tv_sec = 0;
+	timer.it_interval.tv_usec = (f != 0) ? PERIOD : 0;
+	timer.it_value = timer.it_interval;
+
+	if(f != 0) signal(SIGALRM, f);
+
+	setitimer(ITIMER_REAL, &timer, 0);
+
+	if(f == 0) signal(SIGALRM, SIG_IGN);
+}
+
+static void* producer(void* arg)
+{
+	uint32_t seed = 1;
+
+	(void)arg;
+
+	while(produced < TOTAL) {
+		if(produce(next(&seed)) == 0) sched_yield();
+	}
+
+	return 0;
+}
+
+static void reset(void)
+{
+	ring.flush();
+
+	produced = 0;
+	consumed = 0;
+	errors = 0;
+}
+
+static void test_isr_producer(void)
+{
+	uint32_t seed = 7;
+
+	reset();
+	interrupt(&isr_producer);
+
+	// Main loop: consumer (ex: Serial::read)
+	while(consumed < TOTAL)
+		consume(next(&seed));
+
+	interrupt(0);
+
+	CHECK(errors == 0);
+	CHECK(consumed == TOTAL);
+	CHECK(ring.count() == 0);
+}
+
+static void test_isr_consumer(void)
+{
+	uint32_t seed = 11;
+
+	reset();
+	interrupt(&isr_consumer);
+
+	// Main loop: producer (ex: Serial::write)
+	while(produced < TOTAL)
+		produce(next(&seed));
+
+	// Drain
+	while(consumed < produced);
+
+	interrupt(0);
+
+	CHECK(errors == 0);
+	CHECK(consumed == TOTAL);
+}
+
+static void test_parallel(void)
+{
+	pthread_t thread;
+	uint32_t seed = 13;
+
+	reset();
+
+	pthread_create(&thread, 0, &producer, 0);
+
+	while(consumed < TOTAL) {
+		if(consume(next(&seed)) == 0) sched_yield();
+	}
+
+	pthread_join(thread, 0);
+
+	CHECK(errors == 0);
+	CHECK(consumed == TOTAL);
+}
+
+static void test_limits(void)
+{
+	uint8_t data[100] = {0};
+	uint16_t i = 0;
+
+	reset();
+
+	for(i = 0; i < sizeof(data); i++) data[i] = (uint8_t)i;
+
+	// Never more than N elements
+	CHECK(ring.put(data, 100) == 64);
+	CHECK(ring.space() == 0);
+	CHECK(ring.put(0xFF) == 0);
+
+	// Empty
+	CHECK(ring.get(data, 100) == 64);
+	CHECK(data[63] == 63);
+	CHECK(ring.get(data, 100) == 0);
+
+	// DMA overrun: oldest data dropped by the reader
+	ring.commit(64 + 10);
+	CHECK(ring.count() == 64);
+	ring.get(data, 1);
+	CHECK(ring.count() == 63);
+}
+
+int main(void)
+{
+	test_isr_producer();
+	test_isr_consumer();
+	test_parallel();
+	test_limits();
+
+	return host_result();
+}
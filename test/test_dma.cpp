@@ -0,0 +1,206 @@
+/*!
+ * \file test_dma.cpp
+ * \brief DMA driver host test.
+ * \author Remi.Debord
+ * \version 1.0
+ * \date 17 octobre 2026
+ *
+ * DMA1 channel allocation, request mapping, transfer modes and events against the
+ * register mock, Serial fallback to interrupt mode when its channel is owned.
+ *
+ */
+
+#include "Dma.h"
+#include "Serial.h"
+
+extern "C"
+{
+	void DMA1_Channel1_IRQHandler(void);
+	void DMA1_Channel3_IRQHandler(void);
+	void USART1_IRQHandler(void);
+}
+
+static uint8_t events = 0;
+static uint8_t calls = 0;
+static void* context = 0;
+
+static void event(void* c, uint8_t e)
+{
+	context = c;
+	events = e;
+	calls++;
+}
+
+// Flags raised by the channel, then its interrupt
+static void flag(uint8_t channel, uint32_t flags, void(*handler)(void))
+{
+	DMA1->ISR |= ((DMA_ISR_GIF1 | flags) << ((channel - 1) * 4));
+	handler();
+	DMA1->ISR = 0;
+}
+
+static void test_mapping(void)
+{
+	CHECK(Dma::channel(Dma_ADC1) == 1);
+	CHECK(Dma::channel(Dma_SPI1_RX) == 2);
+	CHECK(Dma::channel(Dma_SPI1_TX) == 3);
+	CHECK(Dma::channel(Dma_USART1_TX) == 4);
+	CHECK(Dma::channel(Dma_USART1_RX) == 5);
+	CHECK(Dma::channel(Dma_USART2_RX) == 6);
+	CHECK(Dma::channel(Dma_USART2_TX) == 7);
+	CHECK(Dma::channel(Dma_I2C1_TX) == 6);
+	CHECK(Dma::channel(Dma_I2C1_RX) == 7);
+	CHECK(Dma::channel(Dma_TIM1_UP) == 5);
+	CHECK(Dma::channel(Dma_TIM3_CH1) == 6);
+}
+
+static void test_open(void)
+{
+	static Dma a;
+	static Dma b;
+
+	CHECK(a.opened() == 0);
+	CHECK(a.open(Dma_ADC1, Dma_PeripheralToMemory, Dma_16bits, Dma_High) == 1);
+	CHECK(a.opened() == 1);
+
+	// Channel 1: priority, sizes, memory increment, peripheral to memory
+	CHECK((RCC->AHBENR & RCC_AHBENR_DMA1EN) != 0);
+	CHECK(((DMA1_Channel1->CCR & DMA_CCR_PL) >> DMA_CCR_PL_Pos) == Dma_High);
+	CHECK(((DMA1_Channel1->CCR & DMA_CCR_MSIZE) >> DMA_CCR_MSIZE_Pos) == Dma_16bits);
+	CHECK(((DMA1_Channel1->CCR & DMA_CCR_PSIZE) >> DMA_CCR_PSIZE_Pos) == Dma_16bits);
+	CHECK((DMA1_Channel1->CCR & DMA_CCR_MINC) != 0);
+	CHECK((DMA1_Channel1->CCR & DMA_CCR_DIR) == 0);
+	CHECK(NVIC_GetEnableIRQ(DMA1_Channel1_IRQn) != 0);
+
+	// Owned: another driver cannot take it
+	CHECK(b.open(Dma_TIM2_CH3, Dma_MemoryToPeripheral, Dma_16bits, Dma_Low) == 0);
+	CHECK(b.opened() == 0);
+
+	a.close();
+	CHECK(a.opened() == 0);
+
+	CHECK(b.open(Dma_TIM2_CH3, Dma_MemoryToPeripheral, Dma_16bits, Dma_Low) == 1);
+	CHECK((DMA1_Channel1->CCR & DMA_CCR_DIR) != 0);
+
+	b.close();
+}
+
+static void test_normal(void)
+{
+	static Dma d;
+	static uint8_t buffer[16];
+	static volatile uint32_t peripheral = 0;
+
+	d.open(Dma_SPI1_TX, Dma_MemoryToPeripheral, Dma_8bits, Dma_Medium);
+	d.attach(&event, &d);
+	d.start(&peripheral, buffer, 16, Dma_Normal);
+
+	CHECK(DMA1_Channel3->CNDTR == 16);
+	CHECK(DMA1_Channel3->CPAR == (uint32_t)(uintptr_t)&peripheral);
+	CHECK(DMA1_Channel3->CMAR == (uint32_t)(uintptr_t)buffer);
+	CHECK((DMA1_Channel3->CCR & DMA_CCR_CIRC) == 0);
+	CHECK((DMA1_Channel3->CCR & (DMA_CCR_TCIE | DMA_CCR_TEIE | DMA_CCR_EN)) == (DMA_CCR_TCIE | DMA_CCR_TEIE | DMA_CCR_EN));
+	CHECK(d.busy() == 1);
+
+	// Transfer complete: channel disabled, event reported with context
+	calls = 0;
+	DMA1_Channel3->CNDTR = 0;
+	flag(3, DMA_ISR_TCIF1, &DMA1_Channel3_IRQHandler);
+
+	CHECK(calls == 1);
+	CHECK(events == Dma_Complete);
+	CHECK(context == &d);
+	CHECK(d.busy() == 0);
+	CHECK(d.remaining() == 0);
+
+	// Transfer error: channel disabled
+	d.start(&peripheral, buffer, 16, Dma_Normal);
+	flag(3, DMA_ISR_TEIF1, &DMA1_Channel3_IRQHandler);
+
+	CHECK(events == Dma_Error);
+	CHECK(d.busy() == 0);
+
+	// Flags cleared
+	CHECK(DMA1->IFCR == DMA_IFCR_CGIF3);
+
+	d.close();
+}
+
+static void test_circular(void)
+{
+	static Dma d;
+	static uint16_t buffer[32];
+	static volatile uint32_t peripheral = 0;
+
+	// No callback: no interrupt
+	d.open(Dma_ADC1, Dma_PeripheralToMemory, Dma_16bits, Dma_High);
+	d.start(&peripheral, buffer, 32, Dma_Circular);
+
+	CHECK((DMA1_Channel1->CCR & (DMA_CCR_CIRC | DMA_CCR_EN)) == (DMA_CCR_CIRC | DMA_CCR_EN));
+	CHECK((DMA1_Channel1->CCR & (DMA_CCR_HTIE | DMA_CCR_TCIE | DMA_CCR_TEIE)) == 0);
+
+	// Double buffer: circular on both halves, half/complete events
+	d.attach(&event, 0);
+	d.start(&peripheral, buffer, 16, Dma_DoubleBuffer);
+
+	CHECK(DMA1_Channel1->CNDTR == 32);
+	CHECK((DMA1_Channel1->CCR & (DMA_CCR_HTIE | DMA_CCR_TCIE | DMA_CCR_TEIE)) == (DMA_CCR_HTIE | DMA_CCR_TCIE | DMA_CCR_TEIE));
+
+	calls = 0;
+	flag(1, DMA_ISR_HTIF1, &DMA1_Channel1_IRQHandler);
+	CHECK(events == Dma_Half);
+
+	flag(1, DMA_ISR_TCIF1, &DMA1_Channel1_IRQHandler);
+	CHECK(events == Dma_Complete);
+	CHECK(calls == 2);
+
+	// Running until stopped
+	CHECK(d.busy() == 1);
+
+	d.stop();
+	CHECK(d.busy() == 0);
+
+	d.close();
+}
+
+static void test_serial_fallback(void)
+{
+	static Dma timer;
+	static Serial<32> port(USART1, PA_10, PA_9);
+	SerialSpan span;
+
+	// Channel 5 (USART1 Rx) owned by TIM1 update
+	CHECK(timer.open(Dma_TIM1_UP, Dma_MemoryToPeripheral, Dma_16bits, Dma_High) == 1);
+
+	port.dma();
+
+	// Rx: interrupt mode kept
+	CHECK((USART1->CR1 & USART_CR1_RXNEIE) != 0);
+	CHECK((USART1->CR3 & USART_CR3_DMAR) == 0);
+	CHECK((USART1->CR1 & USART_CR1_IDLEIE) == 0);
+
+	// Tx: DMA (channel 4 free)
+	CHECK((USART1->CR3 & USART_CR3_DMAT) != 0);
+
+	// Still receiving
+	USART1->SR = USART_SR_RXNE;
+	USART1->DR = 'a';
+	USART1_IRQHandler();
+	USART1->SR = 0;
+
+	CHECK(port.read_span(&span) == 1);
+	CHECK(span.data[0][0] == 'a');
+
+	timer.close();
+}
+
+int main(void)
+{
+	test_mapping();
+	test_open();
+	test_normal();
+	test_circular();
+	test_serial_fallback();
+
+	return host_result();
+}
@@ -0,0 +1,56 @@
+/*!
+ * \file test_input_capture.cpp
+ * \brief InputCapture host test.
+ * \author Remi.Debord
+ * \version 1.0
+ * \date 17 octobre 2026
+ *
+ * TIM3 PWM input captures moved by DMA against the TIM3/DMA1 register mock: channel
+ * owned while capturing, released by capture_stop().
+ *
+ */
+
+#include "Timer.h"
+#include "Dma.h"
+
+#define CAPTURES 4
+
+static void test_stop(void)
+{
+	static uint16_t buffer[2 * CAPTURES * 2];
+	InputCapture capture(PA_6, TIM3, 1000000);
+	Dma dma;
+
+	// TIM3 CC1: DMA1 channel 6, CCR1/CCR2 burst
+	CHECK(capture.capture(buffer, CAPTURES, 0) == 1);
+	CHECK((TIM3->DIER & TIM_DIER_CC1DE) != 0);
+	CHECK(DMA1_Channel6->CPAR == (uint32_t)(uintptr_t)&TIM3->DMAR);
+	CHECK(DMA1_Channel6->CNDTR == (2 * CAPTURES * 2));
+	CHECK((DMA1_Channel6->CCR & DMA_CCR_EN) != 0);
+
+	// Channel owned while capturing
+	CHECK(dma.open(Dma_TIM3_CH1, Dma_PeripheralToMemory, Dma_16bits, Dma_Low) == 0);
+
+	capture.capture_stop();
+	CHECK((TIM3->DIER & TIM_DIER_CC1DE) == 0);
+	CHECK((DMA1_Channel6->CCR & DMA_CCR_EN) == 0);
+
+	// Channel released: available to another request, then to a new capture
+	CHECK(dma.open(Dma_TIM3_CH1, Dma_PeripheralToMemory, Dma_16bits, Dma_Low) == 1);
+	dma.close();
+
+	CHECK(capture.capture(buffer, CAPTURES, 0) == 1);
+	capture.capture_stop();
+
+	// Stopped twice: nothing left to release
+	capture.capture_stop();
+	CHECK(dma.open(Dma_USART2_RX, Dma_PeripheralToMemory, Dma_8bits, Dma_Low) == 1);
+	dma.close();
+}
+
+int main(void)
+{
+	test_stop();
+
+	return host_result();
+}
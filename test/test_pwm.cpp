@@ -0,0 +1,195 @@
+/*!
+ * \file test_pwm.cpp
+ * \brief PwmOut host test.
+ * \author Remi.Debord
+ * \version 1.0
+ * \date 17 octobre 2026
+ *
+ * Period shared by the channels of a timer, compare values streamed by timer update
+ * DMA (PwmOut and AnalogOut share the same implementation) against the TIMx/DMA1
+ * register mock.
+ *
+ */
+
+#include "Timer.h"
+#include "Analog.h"
+
+#define LENGTH 4
+
+extern "C"
+{
+	void DMA1_Channel2_IRQHandler(void);
+	void DMA1_Channel3_IRQHandler(void);
+}
+
+static uint16_t* data[4];
+static uint16_t lengths[4];
+static uint8_t calls = 0;
+
+static void refill(uint16_t* buffer, uint16_t length)
+{
+	data[calls] = buffer;
+	lengths[calls] = length;
+	calls++;
+}
+
+// Flags raised by the channel, then its interrupt
+static void flag(uint8_t channel, uint32_t flags, void(*handler)(void))
+{
+	DMA1->ISR |= ((DMA_ISR_GIF1 | flags) << ((channel - 1) * 4));
+	handler();
+	DMA1->ISR = 0;
+}
+
+static void test_shared_period(void)
+{
+	PwmOut a(PB_6, 1000, TIM4, Channel_1);
+	PwmOut b(PB_7, 1000, TIM4, Channel_2);
+	HostWrite* writes = 0;
+	int16_t hold = 0;
+	int16_t release = 0;
+
+	CHECK(a.frequency() == 1000);
+	CHECK(b.period() == a.period());
+
+	// Sibling at 50%, then new period set through the other channel
+	b.write_u16(0x8000);
+	CHECK(TIM4->CCR2 == 18000);
+
+	host_trace_start((uint32_t)(uintptr_t)TIM4, 0x50);
+	a.frequency(20000);
+	host_trace_stop(&writes);
+
+	CHECK(TIM4->ARR == (3600 - 1));
+	CHECK(a.period() == 3600);
+	CHECK(b.period() == 3600);
+	CHECK(b.frequency() == 20000);
+
+	// Duty ratio kept without writing the sibling again
+	CHECK(TIM4->CCR2 == 1800);
+	CHECK(b.read_u16() == 0x8000);
+
+	// Period and compare values switched together (update disabled meanwhile)
+	hold = host_trace_find((uint32_t)(uintptr_t)&TIM4->CR1, TIM_CR1_UDIS, TIM_CR1_UDIS, 0);
+	release = host_trace_find((uint32_t)(uintptr_t)&TIM4->CR1, TIM_CR1_UDIS, 0, hold);
+	CHECK(hold >= 0);
+	CHECK(host_trace_find((uint32_t)(uintptr_t)&TIM4->ARR, 0, 0, 0) > hold);
+	CHECK(host_trace_find((uint32_t)(uintptr_t)&TIM4->CCR2, 0, 0, 0) > hold);
+	CHECK(release > host_trace_find((uint32_t)(uintptr_t)&TIM4->CCR2, 0, 0, 0));
+
+	// Full scale kept
+	b = 100;
+	CHECK(TIM4->CCR2 == 3600);
+
+	a.write_u16(0x4000);
+	b.frequency(10000);
+	CHECK(a.frequency() == 10000);
+	CHECK(TIM4->CCR1 == (7200 / 4));
+	CHECK(TIM4->CCR2 == 7200);
+
+	// Inside the caller's hold(): update kept disabled until its release()
+	a.hold();
+	a.frequency(20000);
+	CHECK((TIM4->CR1 & TIM_CR1_UDIS) != 0);
+	a.release();
+	CHECK(TIM4->CCR1 == (3600 / 4));
+}
+
+static void test_double_buffer(void)
+{
+	static uint16_t buffer[2 * LENGTH];
+	PwmOut pwm(PA_6, 20000, TIM3, Channel_1);
+
+	// TIM3 update: DMA1 channel 3, both halves (2 x length values) to CCR1
+	CHECK(pwm.stream(buffer, LENGTH, Dma_DoubleBuffer, &refill) == 1);
+	CHECK(pwm.streaming() == 1);
+	CHECK((TIM3->DIER & TIM_DIER_UDE) != 0);
+	CHECK(DMA1_Channel3->CPAR == (uint32_t)(uintptr_t)&TIM3->CCR1);
+	CHECK(DMA1_Channel3->CMAR == (uint32_t)(uintptr_t)buffer);
+	CHECK(DMA1_Channel3->CNDTR == (2 * LENGTH));
+	CHECK((DMA1_Channel3->CCR & (DMA_CCR_CIRC | DMA_CCR_HTIE | DMA_CCR_TCIE)) == (DMA_CCR_CIRC | DMA_CCR_HTIE | DMA_CCR_TCIE));
+
+	// First half played, then second one: refill the half not being played
+	calls = 0;
+	flag(3, DMA_ISR_HTIF1, &DMA1_Channel3_IRQHandler);
+	flag(3, DMA_ISR_TCIF1, &DMA1_Channel3_IRQHandler);
+	flag(3, DMA_ISR_HTIF1, &DMA1_Channel3_IRQHandler);
+
+	CHECK(calls == 3);
+	CHECK(data[0] == &buffer[0]);
+	CHECK(data[1] == &buffer[LENGTH]);
+	CHECK(data[2] == &buffer[0]);
+	CHECK(lengths[0] == LENGTH);
+	CHECK(lengths[1] == LENGTH);
+
+	// Still running
+	CHECK(pwm.streaming() == 1);
+
+	pwm.stream_stop();
+
+	CHECK(pwm.streaming() == 0);
+	CHECK((TIM3->DIER & TIM_DIER_UDE) == 0);
+}
+
+static void test_normal(void)
+{
+	static uint16_t buffer[LENGTH] = {10, 20, 30, 0};
+	PwmOut pwm(PA_6, 20000, TIM3, Channel_1);
+
+	pwm.write_u16(0x8000);
+
+	CHECK(pwm.stream(buffer, LENGTH, Dma_Normal, &refill) == 1);
+	CHECK((DMA1_Channel3->CCR & DMA_CCR_CIRC) == 0);
+
+	// Buffer played once: channel disabled
+	calls = 0;
+	flag(3, DMA_ISR_HTIF1, &DMA1_Channel3_IRQHandler);
+	CHECK(calls == 0);
+
+	flag(3, DMA_ISR_TCIF1, &DMA1_Channel3_IRQHandler);
+	CHECK(calls == 1);
+	CHECK(data[0] == &buffer[0]);
+	CHECK(pwm.streaming() == 0);
+
+	// Restart on the same channel, then back to the written duty cycle
+	CHECK(pwm.stream(buffer, LENGTH, Dma_Normal, 0) == 1);
+	pwm.stream_stop();
+
+	CHECK(TIM3->CCR1 == (pwm.period() / 2));
+}
+
+static void test_analog_out(void)
+{
+	static uint16_t buffer[2 * LENGTH];
+	AnalogOut out(PA_0, TIM2, Channel_1);
+	PwmOut pwm(PA_1, 20000, TIM2, Channel_2);
+
+	// TIM2 update: DMA1 channel 2, same callback path as PwmOut
+	CHECK(out.stream(buffer, LENGTH, Dma_DoubleBuffer, &refill) == 1);
+	CHECK(DMA1_Channel2->CPAR == (uint32_t)(uintptr_t)&TIM2->CCR1);
+
+	calls = 0;
+	flag(2, DMA_ISR_TCIF1, &DMA1_Channel2_IRQHandler);
+	CHECK(calls == 1);
+	CHECK(data[0] == &buffer[LENGTH]);
+
+	// One streaming channel per timer
+	CHECK(pwm.stream(buffer, LENGTH, Dma_Circular, 0) == 0);
+
+	out.stream_stop();
+
+	CHECK(pwm.stream(buffer, LENGTH, Dma_Circular, 0) == 1);
+	CHECK(DMA1_Channel2->CPAR == (uint32_t)(uintptr_t)&TIM2->CCR2);
+
+	pwm.stream_stop();
+}
+
+int main(void)
+{
+	test_shared_period();
+	test_double_buffer();
+	test_normal();
+	test_analog_out();
+
+	return host_result();
+}
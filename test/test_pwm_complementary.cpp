@@ -0,0 +1,164 @@
+/*!
+ * \file test_pwm_complementary.cpp
+ * \brief PwmComplementary host test.
+ * \author Remi.Debord
+ * \version 1.0
+ * \date 17 octobre 2026
+ *
+ * TIM1 complementary outputs, channels added to the running timer, dead-time encoding
+ * and break input against the register mock (main output cleared by hardware on break,
+ * re-armed by resume()).
+ *
+ */
+
+#include "Timer.h"
+
+extern "C"
+{
+	void TIM1_BRK_IRQHandler(void);
+}
+
+static uint8_t faults = 0;
+
+static void fault(void)
+{
+	faults++;
+}
+
+// Break input active: MOE cleared asynchronously, BIF raised, then its interrupt if enabled
+static void brk(void)
+{
+	TIM1->BDTR &= ~TIM_BDTR_MOE;
+	TIM1->SR |= TIM_SR_BIF;
+
+	if((TIM1->DIER & TIM_DIER_BIE) != 0) TIM1_BRK_IRQHandler();
+}
+
+static void test_setup(PwmComplementary& pwm)
+{
+	// CH1 and CH1N enabled, active high
+	CHECK((TIM1->CCER & (TIM_CCER_CC1E | TIM_CCER_CC1NE)) == (TIM_CCER_CC1E | TIM_CCER_CC1NE));
+	CHECK((TIM1->CCER & (TIM_CCER_CC1P | TIM_CCER_CC1NP)) == 0);
+
+	// Idle level driven when disabled or on break
+	CHECK((TIM1->BDTR & (TIM_BDTR_OSSR | TIM_BDTR_OSSI | TIM_BDTR_MOE)) == (TIM_BDTR_OSSR | TIM_BDTR_OSSI | TIM_BDTR_MOE));
+
+	// Center-aligned mode 1: ARR reached twice per PWM period
+	CHECK((TIM1->CR1 & TIM_CR1_CMS) == TIM_CR1_CMS_0);
+	CHECK(TIM1->ARR == (1800 - 1));
+	CHECK(pwm.frequency() == 20000);
+
+	// 500ns: 36 ticks
+	CHECK((TIM1->BDTR & TIM_BDTR_DTG) == 36);
+
+	// PB13: alternate function push-pull
+	CHECK(((GPIOB->CRH >> (GPIO_CRH_CNF8_Pos + ((13 - 8) * 4))) & 0x03) == 0x02);
+}
+
+static void test_channels(void)
+{
+	HostWrite* writes = 0;
+
+	// Second channel while CH1 runs: counter neither stopped nor reloaded
+	host_trace_start((uint32_t)(uintptr_t)TIM1, 0x50);
+	PwmComplementary pwm2(PA_9, PB_14, 20000, Channel_2, 500, 1);
+	host_trace_stop(&writes);
+
+	CHECK(host_trace_find((uint32_t)(uintptr_t)&TIM1->CR1, TIM_CR1_CEN, 0, 0) < 0);
+	CHECK(host_trace_find((uint32_t)(uintptr_t)&TIM1->EGR, TIM_EGR_UG, TIM_EGR_UG, 0) < 0);
+	CHECK((TIM1->CR1 & (TIM_CR1_CMS | TIM_CR1_CEN)) == (TIM_CR1_CMS_0 | TIM_CR1_CEN));
+	CHECK(TIM1->ARR == (1800 - 1));
+	CHECK(pwm2.frequency() == 20000);
+	CHECK((TIM1->CCER & (TIM_CCER_CC2E | TIM_CCER_CC2NE)) == (TIM_CCER_CC2E | TIM_CCER_CC2NE));
+
+	// CH4: no complementary output
+	PwmComplementary pwm4(PA_11, PB_15, 20000, Channel_4, 500, 1);
+
+	CHECK((TIM1->CCER & TIM_CCER_CC4E) == 0);
+	CHECK((TIM1->CCER & (TIM_CCER_CC1NE << 12)) == 0);
+	CHECK((TIM1->CCER & (TIM_CCER_CC3E | TIM_CCER_CC3NE)) == 0);
+	CHECK(((GPIOA->CRH >> ((11 - 8) * 4)) & 0x0F) == Pin_InputFloating);
+	CHECK(((GPIOB->CRH >> ((15 - 8) * 4)) & 0x0F) == Pin_InputFloating);
+	CHECK((TIM1->CCER & (TIM_CCER_CC1E | TIM_CCER_CC1NE | TIM_CCER_CC2E | TIM_CCER_CC2NE)) == (TIM_CCER_CC1E | TIM_CCER_CC1NE | TIM_CCER_CC2E | TIM_CCER_CC2NE));
+}
+
+static void test_deadtime(PwmComplementary& pwm)
+{
+	// DTG[7:5] = 0xx: 1 tick steps (72MHz: 13.9ns)
+	CHECK(pwm.deadtime(100) == 111);
+	CHECK((TIM1->BDTR & TIM_BDTR_DTG) == 8);
+
+	// 10x: (64 + DTG[5:0]) x 2 ticks
+	CHECK(pwm.deadtime(2000) == 2000);
+	CHECK((TIM1->BDTR & TIM_BDTR_DTG) == (0x80 | 8));
+
+	// 110: (32 + DTG[4:0]) x 8 ticks
+	CHECK(pwm.deadtime(5000) == 5000);
+	CHECK((TIM1->BDTR & TIM_BDTR_DTG) == (0xC0 | 13));
+
+	// 111: (32 + DTG[4:0]) x 16 ticks
+	CHECK(pwm.deadtime(10000) == 10000);
+	CHECK((TIM1->BDTR & TIM_BDTR_DTG) == (0xE0 | 13));
+
+	// Saturated: 1008 ticks
+	CHECK(pwm.deadtime(20000) == 14000);
+	CHECK((TIM1->BDTR & TIM_BDTR_DTG) == 0xFF);
+
+	// Other BDTR bits kept
+	CHECK((TIM1->BDTR & (TIM_BDTR_OSSR | TIM_BDTR_OSSI | TIM_BDTR_MOE)) == (TIM_BDTR_OSSR | TIM_BDTR_OSSI | TIM_BDTR_MOE));
+}
+
+static void test_break(PwmComplementary& pwm)
+{
+	pwm.fault(PB_12, 1, &fault);
+
+	// Active high break, interrupt enabled
+	CHECK((TIM1->BDTR & (TIM_BDTR_BKE | TIM_BDTR_BKP)) == (TIM_BDTR_BKE | TIM_BDTR_BKP));
+	CHECK((TIM1->DIER & TIM_DIER_BIE) != 0);
+	CHECK(NVIC_GetEnableIRQ(TIM1_BRK_IRQn) != 0);
+	CHECK(pwm.faulted() == 0);
+
+	// Fault: callback once, interrupt disabled while the flag may stay raised
+	brk();
+	CHECK(faults == 1);
+	CHECK(pwm.faulted() == 1);
+	CHECK((TIM1->DIER & TIM_DIER_BIE) == 0);
+	CHECK((TIM1->SR & TIM_SR_BIF) == 0);
+
+	// Resume: outputs and break interrupt re-armed
+	pwm.resume();
+	CHECK(pwm.faulted() == 0);
+	CHECK((TIM1->DIER & TIM_DIER_BIE) != 0);
+
+	// Next fault reported too
+	brk();
+	CHECK(faults == 2);
+	CHECK(pwm.faulted() == 1);
+
+	pwm.resume();
+
+	// Active low break without callback: interrupt stays disabled
+	pwm.fault(PB_12, 0, 0);
+	CHECK((TIM1->BDTR & (TIM_BDTR_BKE | TIM_BDTR_BKP)) == TIM_BDTR_BKE);
+	CHECK((TIM1->DIER & TIM_DIER_BIE) == 0);
+
+	brk();
+	CHECK(faults == 2);
+	CHECK(pwm.faulted() == 1);
+
+	pwm.resume();
+	CHECK(pwm.faulted() == 0);
+	CHECK((TIM1->DIER & TIM_DIER_BIE) == 0);
+}
+
+int main(void)
+{
+	PwmComplementary pwm(PA_8, PB_13, 20000, Channel_1, 500, 1);
+
+	test_setup(pwm);
+	test_channels();
+	test_deadtime(pwm);
+	test_break(pwm);
+
+	return host_result();
+}
@@ -0,0 +1,160 @@
+/*!
+ * \file test_qei.cpp
+ * \brief QEI host test.
+ * \author Remi.Debord
+ * \version 1.0
+ * \date 17 octobre 2026
+ *
+ * 16 bits encoder counter extension against the TIM2 register mock: counter stepped
+ * edge by edge (update on wrap, CC3/CC4 compare flags), interrupt served when enabled
+ * or left pending, jitter around the wrap before the interrupt.
+ *
+ */
+
+#include "Timer.h"
+
+extern "C"
+{
+	void TIM2_IRQHandler(void);
+}
+
+#define FLAGS (TIM_SR_UIF | TIM_SR_CC3IF | TIM_SR_CC4IF)
+
+static void serve(void)
+{
+	if((hostPrimask == 0) && ((TIM2->SR & TIM2->DIER & FLAGS) != 0)) {
+		TIM2_IRQHandler();
+		TIM2->SR &= ~FLAGS;
+	}
+}
+
+// Encoder edges: counter stepped, flags raised, interrupt not served (isr: 0)
+static void move(int32_t steps, uint8_t isr)
+{
+	uint16_t count = 0;
+
+	while(steps != 0) {
+		count = (uint16_t)TIM2->CNT;
+
+		if(steps > 0) {
+			count++;
+			steps--;
+			if(count == 0) TIM2->SR |= TIM_SR_UIF;
+		} else {
+			count--;
+			steps++;
+			if(count == 0xFFFF) TIM2->SR |= TIM_SR_UIF;
+		}
+
+		TIM2->CNT = count;
+
+		if(count == TIM2->CCR3) TIM2->SR |= TIM_SR_CC3IF;
+		if(count == TIM2->CCR4) TIM2->SR |= TIM_SR_CC4IF;
+
+		if(isr != 0) serve();
+	}
+}
+
+static void test_setup(void)
+{
+	QEI qei(PA_0, PA_1, TIM2);
+
+	// Encoder mode 3, full 16 bits range, update interrupt on wrap only
+	CHECK((TIM2->SMCR & TIM_SMCR_SMS) == (TIM_SMCR_SMS_0 | TIM_SMCR_SMS_1));
+	CHECK(TIM2->ARR == 0xFFFF);
+	CHECK((TIM2->CR1 & (TIM_CR1_URS | TIM_CR1_CEN)) == (TIM_CR1_URS | TIM_CR1_CEN));
+
+	// Sampled every third of the range (no output on channels 3/4)
+	CHECK((TIM2->DIER & (TIM_DIER_UIE | TIM_DIER_CC3IE | TIM_DIER_CC4IE)) == (TIM_DIER_UIE | TIM_DIER_CC3IE | TIM_DIER_CC4IE));
+	CHECK(TIM2->CCR3 == 0x5555);
+	CHECK(TIM2->CCR4 == 0xAAAA);
+	CHECK((TIM2->CCER & (TIM_CCER_CC3E | TIM_CCER_CC4E)) == 0);
+
+	qei.reset();
+	CHECK(qei.read64() == 0);
+}
+
+static void test_travel(void)
+{
+	QEI qei(PA_0, PA_1, TIM2);
+
+	qei.reset();
+
+	// Several wraps, never read: extended by interrupt only
+	move(200000, 1);
+	CHECK(qei.read64() == 200000);
+
+	move(-450000, 1);
+	CHECK(qei.read64() == -250000);
+	CHECK(qei.read() == -250000);
+
+	// Exactly one range between two reads
+	move(65536, 1);
+	CHECK(qei.read64() == -250000 + 65536);
+
+	qei.reset();
+	CHECK(qei.read64() == 0);
+	CHECK((TIM2->SR & FLAGS) == 0);
+}
+
+static void test_jitter(void)
+{
+	QEI qei(PA_0, PA_1, TIM2);
+
+	qei.reset();
+
+	// Underflow then overflow before the interrupt (one pending update): no wrap
+	move(-1, 0);
+	move(2, 0);
+	serve();
+	CHECK(qei.read64() == 1);
+
+	// Overflow then underflow before the interrupt: back below zero
+	move(-1, 1);
+	move(65535, 0);
+	move(-65535, 0);
+	serve();
+	CHECK(qei.read64() == 0);
+
+	move(-3, 0);
+	serve();
+	CHECK(qei.read64() == -3);
+
+	// Wrap read before the interrupt, then served
+	move(5, 0);
+	CHECK(qei.read64() == 2);
+	serve();
+	CHECK(qei.read64() == 2);
+}
+
+static void test_masked(void)
+{
+	QEI qei(PA_0, PA_1, TIM2);
+	uint32_t primask = __get_PRIMASK();
+
+	qei.reset();
+
+	// Interrupts masked across a wrap (less than half the range): same count
+	__disable_irq();
+
+	move(-2, 1);
+	CHECK(qei.read64() == -2);
+
+	move(30000, 1);
+	CHECK(qei.read64() == 29998);
+
+	__set_PRIMASK(primask);
+
+	serve();
+	CHECK(qei.read64() == 29998);
+}
+
+int main(void)
+{
+	test_setup();
+	test_travel();
+	test_jitter();
+	test_masked();
+
+	return host_result();
+}
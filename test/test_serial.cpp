@@ -0,0 +1,302 @@
+/*!
+ * \file test_serial.cpp
+ * \brief Serial DMA mode host test.
+ * \author Remi.Debord
+ * \version 1.0
+ * \date 17 octobre 2026
+ *
+ * USART1 in DMA mode against the register mock: channel setup, idle line framing,
+ * Rx ring wrap (half/full transfer without idle line), Tx from caller buffer,
+ * USART2 half-duplex bus turnaround and baud rate reprogrammed after a clock change.
+ *
+ */
+
+#include "Serial.h"
+#include "stm32f1xx_it.h"
+
+extern "C"
+{
+	void USART1_IRQHandler(void);
+	void DMA1_Channel4_IRQHandler(void);
+	void DMA1_Channel5_IRQHandler(void);
+	void USART2_IRQHandler(void);
+}
+
+#define SIZE 64
+
+Serial<SIZE> port(USART1, PA_10, PA_9);
+Serial<SIZE> bus(USART2, PA_3, PA_2);
+
+static uint8_t sent = 0;
+
+static void tx_done(void)
+{
+	sent++;
+}
+
+static void dma_irq(void)
+{
+	if((DMA1->ISR & DMA_ISR_GIF5) != 0) {
+		DMA1_Channel5_IRQHandler();
+		DMA1->ISR &= ~(DMA_ISR_GIF5 | DMA_ISR_TCIF5 | DMA_ISR_HTIF5 | DMA_ISR_TEIF5);
+	}
+}
+
+// USART Rx DMA request served (channel 5): data written at the DMA position,
+// half/full transfer interrupt taken as soon as flagged
+static void receive(const uint8_t* data, uint16_t length)
+{
+	uint8_t* memory = (uint8_t*)(uintptr_t)DMA1_Channel5->CMAR;
+	uint16_t i = 0;
+
+	for(i = 0; i < length; i++) {
+		memory[SIZE - DMA1_Channel5->CNDTR] = data[i];
+		DMA1_Channel5->CNDTR--;
+
+		if(DMA1_Channel5->CNDTR == (SIZE / 2)) DMA1->ISR |= (DMA_ISR_GIF5 | DMA_ISR_HTIF5);
+
+		if(DMA1_Channel5->CNDTR == 0) {
+			DMA1_Channel5->CNDTR = SIZE; // circular
+			DMA1->ISR |= (DMA_ISR_GIF5 | DMA_ISR_TCIF5);
+		}
+
+		dma_irq();
+	}
+}
+
+static void idle(void)
+{
+	USART1->SR |= USART_SR_IDLE;
+	USART1_IRQHandler();
+	USART1->SR &= ~USART_SR_IDLE;
+}
+
+static void test_setup(void)
+{
+	port.dma();
+
+	// Rx: channel 5, circular, peripheral to memory
+	CHECK(DMA1_Channel5->CPAR == (uint32_t)(uintptr_t)&USART1->DR);
+	CHECK(DMA1_Channel5->CNDTR == SIZE);
+	CHECK((DMA1_Channel5->CCR & (DMA_CCR_EN | DMA_CCR_CIRC | DMA_CCR_MINC)) == (DMA_CCR_EN | DMA_CCR_CIRC | DMA_CCR_MINC));
+	CHECK((DMA1_Channel5->CCR & DMA_CCR_DIR) == 0);
+	CHECK((DMA1_Channel5->CCR & (DMA_CCR_HTIE | DMA_CCR_TCIE)) == (DMA_CCR_HTIE | DMA_CCR_TCIE));
+
+	// Tx: channel 4, memory to peripheral, idle
+	CHECK((DMA1_Channel4->CCR & DMA_CCR_DIR) != 0);
+	CHECK((DMA1_Channel4->CCR & DMA_CCR_EN) == 0);
+
+	// USART: DMA requests, idle line interrupt, no per byte interrupt
+	CHECK((USART1->CR3 & (USART_CR3_DMAR | USART_CR3_DMAT)) == (USART_CR3_DMAR | USART_CR3_DMAT));
+	CHECK((USART1->CR1 & USART_CR1_IDLEIE) != 0);
+	CHECK((USART1->CR1 & (USART_CR1_RXNEIE | USART_CR1_TXEIE)) == 0);
+}
+
+static void test_idle(void)
+{
+	uint8_t frame[] = "hello";
+	uint8_t buffer[SIZE] = {0};
+
+	receive(frame, 5);
+
+	// No idle line yet
+	CHECK(port.read(buffer) == 0);
+
+	idle();
+
+	CHECK(port.read(buffer) == 5);
+	CHECK(memcmp(buffer, frame, 5) == 0);
+	CHECK(port.read(buffer) == 0);
+}
+
+static void test_wrap(void)
+{
+	uint8_t data[100] = {0};
+	uint8_t buffer[SIZE] = {0};
+	SerialSpan span;
+	uint16_t length = 0;
+	uint8_t i = 0;
+
+	for(i = 0; i < sizeof(data); i++) data[i] = i;
+
+	// Ring position 5 (idle test): half transfer without idle line,
+	// data up to the ring middle committed by DMA interrupt
+	receive(&data[0], 40);
+
+	length = port.read_span(&span);
+	CHECK(length == 27);
+	CHECK(span.length[0] + span.length[1] == 27);
+	CHECK(span.data[0][0] == 0);
+	CHECK(span.data[0][26] == 26);
+
+	port.consume(27);
+
+	// Full transfer (ring wrap), then idle line
+	receive(&data[40], 30);
+	idle();
+
+	CHECK(port.read(buffer) == 43);
+	CHECK(memcmp(buffer, &data[27], 43) == 0);
+
+	// Exactly one ring of data, then idle line
+	receive(&data[0], SIZE);
+	idle();
+
+	CHECK(port.read(buffer) == SIZE);
+	CHECK(memcmp(buffer, &data[0], SIZE) == 0);
+}
+
+static void test_tx(void)
+{
+	static uint8_t message[] = "0123456789";
+
+	port.attach_tx(&tx_done, 0);
+
+	CHECK(port.writeable() != 0);
+	CHECK(port.write(message, 10) == 10);
+
+	// Sent straight from caller buffer
+	CHECK(DMA1_Channel4->CMAR == (uint32_t)(uintptr_t)message);
+	CHECK(DMA1_Channel4->CPAR == (uint32_t)(uintptr_t)&USART1->DR);
+	CHECK(DMA1_Channel4->CNDTR == 10);
+	CHECK((DMA1_Channel4->CCR & DMA_CCR_EN) != 0);
+
+	// Busy until transfer complete
+	CHECK(port.writeable() == 0);
+	CHECK(port.write(message, 10) == 0);
+
+	DMA1_Channel4->CNDTR = 0;
+	DMA1->ISR |= (DMA_ISR_GIF4 | DMA_ISR_TCIF4);
+	DMA1_Channel4_IRQHandler();
+	DMA1->ISR = 0;
+
+	CHECK((DMA1_Channel4->CCR & DMA_CCR_EN) == 0);
+	CHECK(sent == 1);
+	CHECK(port.writeable() != 0);
+}
+
+static void test_half_duplex(void)
+{
+	// RS-485 transceiver (DE: PA1): Tx pin open-drain, alternate function
+	bus.half_duplex(PA_1);
+
+	CHECK((USART2->CR3 & USART_CR3_HDSEL) != 0);
+	CHECK(((GPIOA->CRL >> ((2 * 4) + 2)) & 0x03) == 0x03);
+	CHECK(((GPIOA->CRL >> (1 * 4)) & 0x03) != 0);
+	CHECK(GPIOA->BRR == (1 << 1));
+
+	// Open-drain bus
+	bus.half_duplex(NC);
+
+	CHECK(((GPIOA->CRL >> ((2 * 4) + 2)) & 0x03) == 0x03);
+}
+
+// Tx ring sent (TXE interrupt), last frame left in the shift register
+static void drain(void)
+{
+	while((USART2->CR1 & USART_CR1_TXEIE) != 0) {
+		USART2->SR = USART_SR_TXE;
+		USART2_IRQHandler();
+	}
+
+	USART2->SR = 0;
+}
+
+// Previous frame transmission complete on every CR1 access
+static void complete(uint16_t count)
+{
+	(void)count;
+
+	USART2->SR = USART_SR_TC;
+	USART2_IRQHandler();
+	USART2->SR = 0;
+}
+
+static void test_turnaround(void)
+{
+	static uint8_t frame[] = "abc";
+	HostWrite* writes = 0;
+	int16_t mask = 0;
+	int16_t send = 0;
+	int16_t release = 0;
+
+	bus.half_duplex(PA_1);
+
+	CHECK(bus.write(frame, 3) == 3);
+	drain();
+
+	// Bus release armed (previous frame in flight, Tx ring empty)
+	CHECK((USART2->CR1 & USART_CR1_TCIE) != 0);
+
+	// Release masked before queuing, armed once the data is queued
+	host_trace_start((uint32_t)(uintptr_t)USART2, sizeof(USART_TypeDef));
+	CHECK(bus.write(frame, 3) == 3);
+	host_trace_stop(&writes);
+
+	mask = host_trace_find((uint32_t)(uintptr_t)&USART2->CR1, USART_CR1_TCIE, 0, 0);
+	send = host_trace_find((uint32_t)(uintptr_t)&USART2->CR1, USART_CR1_TXEIE, USART_CR1_TXEIE, 0);
+	release = host_trace_find((uint32_t)(uintptr_t)&USART2->CR1, USART_CR1_TCIE, USART_CR1_TCIE, mask);
+	CHECK(mask >= 0);
+	CHECK(send > mask);
+	CHECK(release > send);
+
+	drain();
+
+	// Previous frame complete at any point of the write: bus still driven, data queued
+	GPIOA->BSRR = 0;
+	host_hook_start((uint32_t)(uintptr_t)&USART2->CR1, &complete);
+	CHECK(bus.write(frame, 3) == 3);
+	host_hook_stop();
+
+	CHECK(GPIOA->BSRR == (1 << 1));
+	CHECK((USART2->CR1 & (USART_CR1_RE | USART_CR1_TXEIE | USART_CR1_TCIE)) == (USART_CR1_TXEIE | USART_CR1_TCIE));
+
+	// Last frame sent: bus released, receiver enabled
+	drain();
+	GPIOA->BRR = 0;
+	complete(0);
+
+	CHECK(GPIOA->BRR == (1 << 1));
+	CHECK((USART2->CR1 & (USART_CR1_RE | USART_CR1_TCIE)) == USART_CR1_RE);
+}
+
+static void test_clock(void)
+{
+	uint32_t cfgr = RCC->CFGR;
+	uint32_t clock = SystemCoreClock;
+
+	port.baudrate(115200);
+	bus.baudrate(9600);
+
+	// 72MHz, PCLK1 = PCLK2 = HCLK
+	RCC->CFGR &= ~(RCC_CFGR_PPRE1 | RCC_CFGR_PPRE2);
+	SerialBase::clock_update();
+	CHECK(USART1->BRR == 625);
+	CHECK(USART2->BRR == 7500);
+
+	// New clock tree (ex: after stop mode): 36MHz, PCLK1 = HCLK / 2
+	SystemCoreClock = 36000000;
+	RCC->CFGR |= RCC_CFGR_PPRE1_DIV2;
+	SerialBase::clock_update();
+	CHECK(USART1->BRR == 313);
+	CHECK(USART2->BRR == 1875);
+	CHECK(port.baudrate_achieved() == 115016);
+	CHECK((USART1->CR1 & USART_CR1_UE) != 0);
+
+	SystemCoreClock = clock;
+	RCC->CFGR = cfgr;
+	SerialBase::clock_update();
+}
+
+int main(void)
+{
+	test_setup();
+	test_idle();
+	test_wrap();
+	test_tx();
+	test_half_duplex();
+	test_turnaround();
+	test_clock();
+
+	return host_result();
+}
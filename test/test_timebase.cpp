@@ -0,0 +1,214 @@
+/*!
+ * \file test_timebase.cpp
+ * \brief Microsecond timebase host test.
+ * \author Remi.Debord
+ * \version 1.0
+ * \date 17 octobre 2026
+ *
+ * SysTick_Micros() (stm32f1xx_it.c) with the SysTick reload in flight: tick interrupt
+ * between two reads, reload pending with interrupts masked or seen between VAL and ICSR
+ * reads. Timer read functions beyond the 16 bits counter range.
+ *
+ */
+
+#include "Timer.h"
+#include "stm32f1xx_it.h"
+#include "stm32f1xx_hal_pcd.h"
+
+#define RELOAD ((72000000 / 1000) - 1)  // 1ms tick
+
+extern __IO uint32_t sysTick;
+extern __IO uint32_t sysTickHigh;
+
+// HAL and USB stubs (stm32f1xx_it.c)
+PCD_HandleTypeDef hpcd_USB_FS;
+
+extern "C"
+{
+	void HAL_IncTick(void) {}
+	void HAL_PCD_IRQHandler(PCD_HandleTypeDef* hpcd) { (void)hpcd; }
+}
+
+static uint32_t seed = 1;
+
+static uint32_t next(void)
+{
+	seed = (seed * 1103515245UL) + 12345UL;
+
+	return (seed >> 8);
+}
+
+// SysTick at ms + ticks elapsed in the current period, no reload pending
+static void set(uint32_t ms, uint32_t ticks)
+{
+	sysTick = ms;
+	sysTickHigh = 0;
+	SysTick->LOAD = RELOAD;
+	SysTick->VAL = RELOAD - ticks;
+	SCB->ICSR &= ~SCB_ICSR_PENDSTSET_Msk;
+}
+
+// Counter reached 0: reloaded, tick interrupt pending
+static void reload(void)
+{
+	SysTick->VAL = RELOAD;
+	SCB->ICSR |= SCB_ICSR_PENDSTSET_Msk;
+}
+
+// Tick interrupt taken
+static void serve(void)
+{
+	SCB->ICSR &= ~SCB_ICSR_PENDSTSET_Msk;
+	SysTick_Handler();
+}
+
+// Interrupt between the tick and VAL reads (thread context)
+static void interrupt(uint16_t count)
+{
+	if(count == 0) {
+		reload();
+		serve();
+	}
+}
+
+// Reload while the tick interrupt is masked
+static void masked(uint16_t count)
+{
+	if(count == 0) reload();
+}
+
+static void test_micros(void)
+{
+	// 5ms + 36000 ticks (500us)
+	set(5, 36000);
+	CHECK(SysTick_Micros() == 5500);
+
+	// 1 tick short of the reload
+	set(5, RELOAD);
+	CHECK(SysTick_Micros() == 5999);
+
+	// Tick interrupt served between the tick and VAL reads: retried
+	set(5, RELOAD);
+	host_hook_start((uint32_t)(uintptr_t)&SysTick->VAL, &interrupt);
+	CHECK(SysTick_Micros() == 6000);
+	host_hook_stop();
+	CHECK(sysTick == 6);
+
+	// Reload pending (interrupts masked or higher priority handler): counted once
+	set(5, RELOAD);
+	host_hook_start((uint32_t)(uintptr_t)&SysTick->VAL, &masked);
+	CHECK(SysTick_Micros() == 6000);
+	host_hook_stop();
+	CHECK(SysTick_Micros() == 6000);
+	CHECK(sysTick == 5);
+
+	// Reload between the VAL and ICSR reads: VAL read again
+	set(5, RELOAD);
+	host_hook_start((uint32_t)(uintptr_t)&SCB->ICSR, &masked);
+	CHECK(SysTick_Micros() == 6000);
+	host_hook_stop();
+
+	// 32 bits tick count wrap pending
+	set(0xFFFFFFFF, RELOAD);
+	reload();
+	CHECK(SysTick_Micros() == (((uint64_t)1 << 32) * 1000));
+
+	serve();
+	CHECK(sysTick == 0);
+	CHECK(sysTickHigh == 1);
+	CHECK(SysTick_Micros() == (((uint64_t)1 << 32) * 1000));
+}
+
+static void test_monotonic(void)
+{
+	uint64_t ticks = 0;
+	uint64_t now = 0;
+	uint64_t last = 0;
+	uint32_t elapsed = 0;
+	uint32_t step = 0;
+	uint32_t i = 0;
+	uint8_t errors = 0;
+
+	set(0, 0);
+
+	// Random steps, interrupt served late or at once
+	for(i = 0; i < 200000; i++) {
+		step = next() % 100000;
+		ticks += step;
+
+		elapsed = (RELOAD - SysTick->VAL) + step;
+
+		if(elapsed > RELOAD) {
+			// At most one pending reload (tick interrupt masked < 1ms)
+			if((SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) != 0) serve();
+
+			SCB->ICSR |= SCB_ICSR_PENDSTSET_Msk;
+			elapsed -= (RELOAD + 1);
+
+			if(elapsed > RELOAD) {
+				serve();
+				SCB->ICSR |= SCB_ICSR_PENDSTSET_Msk;
+				elapsed -= (RELOAD + 1);
+			}
+		}
+
+		SysTick->VAL = RELOAD - elapsed;
+
+		if((next() & 0x01) != 0) {
+			if((SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) != 0) serve();
+		}
+
+		now = SysTick_Micros();
+
+		if((now < last) || (now != (ticks / 72))) errors++;
+
+		last = now;
+	}
+
+	CHECK(errors == 0);
+	CHECK(last > (60 * 1000000));
+}
+
+static void test_timer(void)
+{
+	Timer timer(TIM2);
+
+	set(1000, 0);
+
+	timer.reset();
+	timer.start();
+
+	// Beyond the 16 bits counter (65.5ms)
+	set(1100, 36000);
+	CHECK(timer.read_us() == 100500);
+	CHECK(timer.read_ms() == 100);
+
+	set(71000, 0);
+	CHECK(timer.read() == 70);
+
+	// Stopped: time kept, start() again resumes
+	timer.stop();
+	set(80000, 0);
+	CHECK(timer.read_ms() == 70000);
+
+	timer.start();
+	set(80250, 0);
+	CHECK(timer.read_ms() == 70250);
+
+	// start() while running: time kept
+	timer.start();
+	CHECK(timer.read_ms() == 70250);
+
+	timer.reset();
+	set(80260, 0);
+	CHECK(timer.read_ms() == 10);
+}
+
+int main(void)
+{
+	test_micros();
+	test_monotonic();
+	test_timer();
+
+	return host_result();
+}